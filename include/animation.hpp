@@ -1,25 +1,40 @@
 #pragma once
 
 #include <chrono>
+#include <memory_resource>
 
 namespace fb {
-struct Animation;
-struct Frame;
-struct FrameSeq;
-
-int CreateAnimation(Animation *&);
-int DestroyAnimation(Animation *);
-int AddFrame(Animation *, Frame *&, int left, int top, int width, int height);
-int AddFrameSequence(Animation *, FrameSeq *&);
-int AddFrameToSequence(FrameSeq *, Frame *);
-
-int SetFrameDuration(FrameSeq *, std::chrono::milliseconds);
-int GetFrameDuration(FrameSeq *, std::chrono::milliseconds *);
-int SetFrameSequence(Animation *, FrameSeq *);
-int GetActiveFrame(Animation *, Frame *&);
-
-int GetFrameLeft(Frame *, int *);
-int GetFrameTop(Frame *, int *);
-int GetFrameWidth(Frame *, int *);
-int GetFrameHeight(Frame *, int *);
+/* Owns every frame, frame sequence and animation in flat arrays, which
+ * are referred to by integer indices. Frames and sequences are shared,
+ * so any number of animations may play the same sequence. All animations
+ * are advanced in a single pass, from a single clock sample.
+ */
+struct AnimationSystem;
+
+/* The system and all of its arrays are allocated from the resource */
+int CreateAnimationSystem(
+    AnimationSystem *&,
+    std::pmr::memory_resource * = std::pmr::get_default_resource());
+int DestroyAnimationSystem(AnimationSystem *);
+
+int AddFrame(AnimationSystem *, int &frame, int left, int top, int width,
+             int height);
+int AddFrameSequence(AnimationSystem *, int &seq);
+int AddFrameToSequence(AnimationSystem *, int seq, int frame);
+
+int SetFrameDuration(AnimationSystem *, int seq, std::chrono::milliseconds);
+int GetFrameDuration(AnimationSystem *, int seq, std::chrono::milliseconds *);
+
+int CreateAnimation(AnimationSystem *, int &animation);
+int SetFrameSequence(AnimationSystem *, int animation, int seq);
+
+/* A paused animation keeps showing its active frame */
+int SetAnimationPaused(AnimationSystem *, int animation, bool);
+
+int AdvanceAnimations(AnimationSystem *,
+                      std::chrono::steady_clock::time_point now);
+int GetActiveFrame(AnimationSystem *, int animation, int &frame);
+
+int GetFrameRect(AnimationSystem *, int frame, int *left, int *top,
+                 int *width, int *height);
 } // namespace fb
@@ -1,10 +1,20 @@
 #pragma once
 
 namespace sf {
-class Drawable;
-}
+class RectangleShape;
+class Sprite;
+class Text;
+class Texture;
+class VertexArray;
+} // namespace sf
 
 namespace fb {
+struct ResourceCache;
+struct AssetLoader;
+struct CommandQueue;
+struct InputQueue;
+struct SpriteBatch;
+
 /* This structure controls the basic aspects of the program.
  * For instance, the max framerate, the window properties,
  * etc...
@@ -18,26 +28,57 @@ void ScheduleExit(Application *);
 void ScheduleSceneTransition(Application *, const char *);
 void ScheduleSceneClear(Application *);
 
+/* Starts decoding the dependencies of a scene in the background, and
+ * builds the scene as soon as they are ready. A transition to a scene
+ * which is not ready yet goes through the loading screen instead.
+ */
+void PrefetchScene(Application *, const char *);
+bool IsSceneReady(Application *, const char *);
+
 /* Returns the time spent on processing the most recent completed frame */
 double GetFrameTimeInSeconds(Application *);
 
-float GetMousePositionX(Application *);
-float GetMousePositionY(Application *);
+/* Returns the fixed duration of a single simulation tick. Scene::update
+ * is called once per tick, possibly several times within one frame.
+ */
+double GetTickDurationInSeconds(Application *);
+
+/* Returns how far the current frame lies between the previous and the
+ * most recent tick, in the range [0, 1). Used to interpolate when rendering.
+ */
+float GetInterpolationFactor(Application *);
+
 float GetWindowSizeX(Application *);
 float GetWindowSizeY(Application *);
-unsigned GetScore(Application *);
-void IncrementScore(Application *);
-
-bool IsPrimaryMouseButtonPressed(Application *);
-void SetButtonClicked(Application *, bool);
-bool IsButtonClicked(Application *);
-void SetButtonHovered(Application *, bool);
-bool IsButtonHovered(Application *);
+ResourceCache *GetResourceCache(Application *);
+AssetLoader *GetAssetLoader(Application *);
+SpriteBatch *GetSpriteBatch(Application *);
+
+/* Commands posted here, from any thread, run on the main thread at the
+ * end of the current frame
+ */
+CommandQueue *GetCommandQueue(Application *);
+
+/* Blocks until the frames presented so far no longer reference any
+ * texture, e.g. before one is released or drawn into
+ */
+void FinishPresentedFrames(Application *);
+
+/* The input of the current tick */
+InputQueue *GetInputQueue(Application *);
 bool IsFlapRequested(Application *);
 
 unsigned GetRandomNumber(Application *, unsigned inclBegin, unsigned exclEnd);
 
-void Render(Application *, sf::Drawable *);
+/* Every call is one draw call. Drawing a shape, sprite or text first
+ * flushes the sprite batch, so that whatever was batched before it stays
+ * beneath it. With the render thread the drawables are copied into the
+ * snapshot of the frame, so they may change right after the call.
+ */
+void Render(Application *, const sf::Text *);
+void Render(Application *, const sf::RectangleShape *);
+void Render(Application *, const sf::Sprite *);
+void Render(Application *, const sf::VertexArray &, const sf::Texture *);
 
 void LogErr(const char *, int);
 void LogErr(const char *);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace fb {
+/* The layout of an asset archive. A header is followed by an index of
+ * entries sorted by name, which is followed by the contents of the
+ * entries, each starting at a multiple of the alignment.
+ */
+namespace pak {
+constexpr char magic[4]{'F', 'B', 'P', 'K'};
+constexpr std::uint32_t version{1};
+constexpr std::size_t alignment{64};
+constexpr std::size_t nameLength{48};
+
+struct Header {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t count;
+  std::uint32_t reserved;
+};
+
+struct Entry {
+  char name[nameLength];
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+static_assert(sizeof(Header) == 16);
+static_assert(sizeof(Entry) == 64);
+} // namespace pak
+
+/* A read only view of an archive mapped into memory. The data handed out
+ * by FindArchiveEntry stays valid until the archive is closed.
+ */
+struct Archive;
+
+int OpenArchive(Archive *&, const std::string &path);
+int CloseArchive(Archive *);
+
+int FindArchiveEntry(Archive *, const std::string &name, const void **data,
+                     std::size_t *size);
+
+/* As of when the archive was opened, in ticks of the filesystem clock */
+std::int64_t GetArchiveModificationTime(Archive *);
+
+/* Turns a path relative to the working directory, e.g. ./img/a.png,
+ * into the name of its archive entry, e.g. img/a.png
+ */
+std::string GetArchiveEntryName(const std::string &path);
+} // namespace fb
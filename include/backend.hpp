@@ -0,0 +1,58 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <input.hpp>
+#include <optional>
+#include <string>
+
+namespace fb {
+/* Everything rendered through the application ends up here. Besides the
+ * window, drawn on the main thread or on a render thread, there is a
+ * backend which only records what would be drawn, so that the draw calls
+ * of a scene can be measured without a display.
+ */
+struct RenderBackend {
+  RenderBackend() = default;
+  virtual ~RenderBackend() = default;
+  RenderBackend(const RenderBackend &) = delete;
+  RenderBackend &operator=(const RenderBackend &) = delete;
+
+  virtual bool isOpen() const = 0;
+  virtual void close() = 0;
+  virtual sf::Vector2u getSize() const = 0;
+  virtual std::optional<sf::Event> pollEvent() = 0;
+
+  /* Blocks until an event arrives, or the timeout expires */
+  virtual std::optional<sf::Event> waitEvent(std::chrono::milliseconds) = 0;
+
+  virtual void begin() = 0;
+  virtual void draw(const sf::Text &) = 0;
+  virtual void draw(const sf::RectangleShape &) = 0;
+  virtual void draw(const sf::Sprite &) = 0;
+  virtual void draw(const sf::VertexArray &, const sf::Texture *) = 0;
+
+  /* Ends the frame. The press is the oldest one the frame responds to,
+   * and its latency is reported by takeLatency once the frame is shown.
+   */
+  virtual void present(std::optional<InputClock::time_point> press) = 0;
+  virtual int takeLatency(std::chrono::microseconds *) = 0;
+
+  /* Blocks until the frames presented so far no longer reference any
+   * texture, after which they may be released
+   */
+  virtual void finish() {}
+};
+
+int CreateWindowBackend(RenderBackend *&, sf::VideoMode, bool renderThread);
+
+/* Opens no window. Every draw is appended to the file at path as a line of
+ * frame,primitive,vertices,texture,left,top,width,height and a summary of
+ * the draw calls, vertices and overdraw per frame is printed on destroy.
+ * Without a path, the draws are only counted.
+ */
+int CreateRecordingBackend(RenderBackend *&, sf::Vector2u size,
+                           const std::string &path);
+
+int DestroyRenderBackend(RenderBackend *);
+} // namespace fb
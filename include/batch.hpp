@@ -0,0 +1,26 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+namespace fb {
+struct Application;
+
+/* Accumulates quads into a single vertex array, which is drawn once per
+ * run of quads sharing the same texture. Consecutive sprites of the same
+ * texture, and consecutive untextured shapes, thus cost one draw call.
+ * The batch is flushed whenever the texture changes, and before anything
+ * else is rendered through the application, so the drawing order is kept.
+ */
+struct SpriteBatch;
+
+int CreateSpriteBatch(SpriteBatch *&, Application *);
+int DestroySpriteBatch(SpriteBatch *);
+
+void Draw(SpriteBatch *, const sf::Sprite &);
+
+/* Only the fill of the shape is drawn, the outline is ignored */
+void Draw(SpriteBatch *, const sf::RectangleShape &);
+void Draw(SpriteBatch *, const sf::FloatRect &, sf::Color);
+
+void FlushSpriteBatch(SpriteBatch *);
+} // namespace fb
@@ -1,21 +1,18 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
-#include <memory>
+#include <functional>
+#include <optional>
 
 namespace fb {
 struct Application;
 
 struct Button : public sf::Drawable {
-private:
-  bool hover_{false}, click_{false};
-
-public:
   std::function<void(Application *, Button *)> onUnHover;
   std::function<void(Application *, Button *)> onHover;
   std::function<void(Application *, Button *)> onUnClick;
   std::function<void(Application *, Button *)> onClick;
-  std::unique_ptr<sf::Text> text;
+  std::optional<sf::Text> text;
   sf::RectangleShape box;
 
   void draw(sf::RenderTarget &t, sf::RenderStates s) const override {
@@ -24,7 +21,27 @@ public:
       t.draw(*text, s);
   }
 
-  void update(Application *a);
   void centerText();
 };
+
+/* Dispatches the pointer to the buttons of a scene. The bounds of the
+ * buttons are cached in a grid, and looked up only in the ticks in which
+ * the pointer moved or the primary button changed, so idle ticks cost
+ * nothing however many buttons there are. Where buttons overlap, the one
+ * added last is on top. At most one button is hovered, and the clicked
+ * one is released where it was clicked.
+ */
+struct ButtonLayer;
+
+int CreateButtonLayer(ButtonLayer *&);
+int DestroyButtonLayer(ButtonLayer *);
+
+/* The button has to stay at the same address until the layer is cleared */
+void AddButton(ButtonLayer *, Button *);
+void ClearButtons(ButtonLayer *);
+
+/* To be called once per tick. Reports whether any button was hovered,
+ * unhovered, clicked or released.
+ */
+bool UpdateButtons(ButtonLayer *, Application *);
 } // namespace fb
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Broad-phase collision detection over a uniform grid. The grid is
+ * rebuilt from scratch each tick, which for moving bodies is cheaper than
+ * keeping it up to date. Colliders are identified by their index in the
+ * array the grid was built from.
+ */
+namespace fb::sim {
+struct Rect {
+  float x{0}, y{0}, w{0}, h{0};
+};
+
+/* The narrow-phase test, touching edges do not count as an intersection */
+bool Intersects(const Rect &, const Rect &);
+
+/* The infinite plane is split into square cells, which are hashed into a
+ * fixed number of buckets. Each bucket holds the colliders overlapping
+ * any of its cells, laid out contiguously in the entries array. Distinct
+ * cells sharing a bucket only cost extra narrow-phase tests.
+ */
+struct Grid {
+  float cellSize{128};
+  std::vector<Rect> rects;
+  std::vector<std::uint32_t> bucketStart;
+  std::vector<std::uint32_t> entries;
+
+  /* Makes sure that a collider spanning several cells of a single query
+   * is reported only once
+   */
+  std::vector<std::uint32_t> stamps;
+  std::uint32_t stamp{0};
+};
+
+int Build(Grid *, const Rect *, std::size_t count);
+
+/* Collects the indices of the colliders intersecting the given rect, in
+ * no particular order
+ */
+int Query(Grid *, const Rect &, std::vector<std::uint32_t> *hits);
+} // namespace fb::sim
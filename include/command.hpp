@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace fb {
+struct Application;
+
+/* A command is stored inline, so posting one never allocates. For that
+ * reason only small, trivially copyable callables are accepted, e.g.
+ * lambdas capturing pointers and numbers by value.
+ */
+struct Command {
+  void (*invoke)(void *, Application *){nullptr};
+  alignas(std::max_align_t) unsigned char data[48];
+};
+
+template <typename F> Command MakeCommand(F f) {
+  static_assert(std::is_trivially_copyable_v<F>,
+                "Commands are copied bytewise between threads");
+  static_assert(sizeof(F) <= sizeof(Command::data) &&
+                    alignof(F) <= alignof(std::max_align_t),
+                "The command does not fit into the inline storage");
+
+  Command c{};
+  new (c.data) F(f);
+  c.invoke = [](void *p, Application *a) {
+    (*std::launder(static_cast<F *>(p)))(a);
+  };
+  return c;
+}
+
+/* A bounded ring buffer of commands. Any number of threads may post into
+ * it without locking, while a single thread drains it.
+ */
+struct CommandQueue;
+
+/* The capacity is rounded up to a power of two */
+int CreateCommandQueue(CommandQueue *&, std::size_t capacity);
+int DestroyCommandQueue(CommandQueue *);
+
+/* Fails with Result::Error when the queue is full */
+int EnqueueCommand(CommandQueue *, const Command &);
+
+template <typename F> int PostCommand(CommandQueue *q, F f) {
+  return EnqueueCommand(q, MakeCommand(f));
+}
+
+/* Runs the queued commands in order, including the ones they post */
+int DrainCommandQueue(CommandQueue *, Application *);
+} // namespace fb
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <simulation.hpp>
+
+/* Many independent worlds stepped in parallel, e.g. to train bots or to
+ * tune the difficulty by playing lots of games. Each environment starts
+ * a new game with a seed of its own as soon as the previous one is over.
+ */
+namespace fb::sim {
+/* What a policy sees of a world, scaled by the size of the window:
+ * the vertical position and velocity of the bird, the horizontal
+ * distance to the next fence along with its top and height, the
+ * distance to the first rocket on both axes, and whether the bird was
+ * launched.
+ */
+constexpr std::size_t observationSize{8};
+
+/* Called concurrently for different environments, so it must not touch
+ * any shared state without synchronizing
+ */
+using Policy = std::function<Input(std::size_t env, const float *observation)>;
+
+struct Environments;
+
+/* The seed of the config seeds the stream of game seeds of each
+ * environment. No more than threads workers step the environments,
+ * the calling thread being one of them.
+ */
+int CreateEnvironments(Environments *&, const Config &, std::size_t count,
+                       unsigned threads);
+int DestroyEnvironments(Environments *);
+
+/* Advances every environment by the given number of steps, and returns
+ * once all of them are done. Environments are handed out to the workers
+ * in chunks, and a worker which runs out of chunks steals from the others.
+ */
+int Run(Environments *, const Policy &, std::size_t steps);
+
+std::size_t Count(const Environments *);
+
+/* Count() rows of observationSize, as of the end of the last run */
+const float *GetObservations(const Environments *);
+
+/* Count() rows of one value per step of the last run. The reward is the
+ * number of fences passed in the step, minus one when the game ended.
+ */
+const float *GetRewards(const Environments *);
+const std::uint8_t *GetDone(const Environments *);
+
+/* The games finished so far, and their total score */
+std::uint64_t GetEpisodeCount(const Environments *);
+std::uint64_t GetTotalScore(const Environments *);
+} // namespace fb::sim
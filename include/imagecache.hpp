@@ -0,0 +1,65 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <string>
+
+namespace fb {
+struct Archive;
+
+/* The layout of a cached image. A header is followed by the source the
+ * image was decoded from and by its pixels, as raw RGBA, row by row.
+ */
+namespace rgba {
+constexpr char magic[4]{'F', 'B', 'I', 'C'};
+constexpr std::uint32_t version{1};
+
+struct Header {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t width;
+  std::uint32_t height;
+  std::int64_t mtime;
+  std::uint64_t size;
+  std::uint32_t sourceLength;
+  std::uint32_t reserved;
+};
+
+static_assert(sizeof(Header) == 40);
+} // namespace rgba
+
+/* What a cached image was decoded from. A source which was modified or
+ * resized since no longer matches its entry.
+ */
+struct ImageKey {
+  std::string source;
+  std::int64_t mtime{0};
+  std::uint64_t size{0};
+};
+
+/* Keys the image by the file at path */
+int GetImageKey(const std::string &path, ImageKey *);
+
+/* Keys the image by an archive entry, which changes along with the
+ * archive
+ */
+int GetImageKey(Archive *, const std::string &name, ImageKey *);
+
+/* Keeps decoded images in a directory, one file per source, so that an
+ * image decoded once is read back with a single mapping rather than
+ * decoded again, including by later runs. Entries are only validated
+ * against their key, which takes a look at the header. Safe to use from
+ * several threads at once.
+ */
+struct ImageCache;
+
+int CreateImageCache(ImageCache *&, const std::string &dir);
+int DestroyImageCache(ImageCache *);
+
+/* Return NotFound on a miss */
+int ReadCachedImage(ImageCache *, const ImageKey &, sf::Image *);
+int ReadCachedTexture(ImageCache *, const ImageKey &, sf::Texture *);
+
+/* Replaces the entry as a whole, so that readers never see a partial one */
+int WriteCachedImage(ImageCache *, const ImageKey &, const sf::Image &);
+} // namespace fb
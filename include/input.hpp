@@ -0,0 +1,49 @@
+#pragma once
+
+#include <SFML/Window/Event.hpp>
+#include <chrono>
+
+namespace fb {
+/* The controls of the game, each bound to a key or a mouse button */
+enum class Control { Flap, Primary, Count };
+
+/* Collects the input events polled from the window, each stamped with the
+ * time it was polled, and hands them out tick by tick. Every tick takes
+ * all the events queued since the previous one and reports the edges
+ * they caused, so a tap which starts and ends between two ticks is still
+ * seen as a press.
+ */
+struct InputQueue;
+
+using InputClock = std::chrono::steady_clock;
+
+int CreateInputQueue(InputQueue *&);
+int DestroyInputQueue(InputQueue *);
+
+void FeedEvent(InputQueue *, const sf::Event &, InputClock::time_point);
+
+/* Applies the queued events, to be called before each tick */
+void BeginTick(InputQueue *);
+
+bool IsDown(InputQueue *, Control);
+bool WasPressed(InputQueue *, Control);
+bool WasReleased(InputQueue *, Control);
+sf::Vector2f GetPointerPosition(InputQueue *);
+
+/* Whether the pointer moved, was pressed or was released since the
+ * previous tick
+ */
+bool WasPointerMoved(InputQueue *);
+
+/* Whether any event was fed since the previous tick, which the next one
+ * has yet to apply
+ */
+bool HasPendingInput(InputQueue *);
+
+/* To be called once the frame is displayed. Reports the time from the
+ * oldest press applied during the frame until the given moment, and
+ * fails with Result::NotFound when nothing was pressed.
+ */
+int TakeInputLatency(InputQueue *, InputClock::time_point displayed,
+                     std::chrono::microseconds *);
+} // namespace fb
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fb {
+struct Application;
+
+/* Shows a fixed prefix followed by a number, anchored at its centre.
+ * The quads of the ten digits are baked from the font once, so changing
+ * the number only rewrites the vertices of the digits which changed,
+ * without allocating and without laying the text out again.
+ */
+struct NumberLabel {
+  static constexpr std::size_t maxDigits{10};
+
+  int build(const sf::Font &, unsigned characterSize, sf::Color,
+            const std::string &prefix);
+  void set(unsigned value);
+  unsigned get() const { return value_; }
+
+  /* Moves the centre of the label to the given point */
+  void setPosition(sf::Vector2f);
+
+  friend void Render(Application *, const NumberLabel *);
+
+private:
+  sf::Vector2f getOrigin() const;
+  void place(std::size_t digit);
+
+  using Quad = std::array<sf::Vertex, 6>;
+
+  const sf::Font *font_{nullptr};
+  unsigned characterSize_{0};
+  std::unique_ptr<sf::Text> prefix_;
+
+  /* The digits are laid out at a fixed pitch, so that they do not shift
+   * as the number changes
+   */
+  float prefixWidth_{0}, pitch_{0}, centreY_{0};
+  std::array<Quad, 10> glyphs_{};
+
+  /* Laid out in window coordinates, so that the label is drawn as is */
+  sf::Vector2f anchor_{};
+  sf::VertexArray vertices_{sf::PrimitiveType::Triangles};
+  std::array<std::uint8_t, maxDigits> digits_{};
+  std::size_t count_{0};
+  unsigned value_{0};
+};
+
+/* Draws the prefix and then the digits, as two draw calls */
+void Render(Application *, const NumberLabel *);
+
+/* Appends the quads sf::Text would draw, as triangles in window
+ * coordinates, to be drawn with the texture of the font at the character
+ * size. Regular style only, which is all the game uses.
+ */
+void AppendTextVertices(const sf::Text &, std::vector<sf::Vertex> *);
+} // namespace fb
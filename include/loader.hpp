@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <resource.hpp>
+#include <string>
+
+namespace fb {
+/* Decodes images into sf::Image on a pool of worker threads. Turning an
+ * image into a texture requires the OpenGL context, so that part, as
+ * well as invoking the completion callback, happens on the thread which
+ * calls PumpAssetLoader. Finished textures are stored in the cache.
+ */
+struct AssetLoader;
+
+using TextureCallback = std::function<void(int result, TextureHandle)>;
+
+int CreateAssetLoader(AssetLoader *&, ResourceCache *, unsigned threads);
+int DestroyAssetLoader(AssetLoader *);
+
+int RequestTexture(AssetLoader *, const std::string &path,
+                   TextureCallback = {});
+
+/* Uploads the images decoded so far and runs their callbacks */
+int PumpAssetLoader(AssetLoader *);
+
+/* Reports the number of finished requests and the number of all requests
+ * made since the loader became idle for the last time.
+ */
+int GetAssetLoaderProgress(AssetLoader *, std::size_t *done,
+                           std::size_t *total);
+} // namespace fb
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+
+namespace fb {
+/* Starts frames at fixed, absolute deadlines one period apart, so that
+ * the error of one wait does not carry over into the next. The wait
+ * sleeps until shortly before the deadline, and spins for the rest. The
+ * spin margin follows how late the sleeps have been returning, so a
+ * scheduler with fine timers costs little spinning.
+ */
+struct FramePacer;
+
+using PacerClock = std::chrono::steady_clock;
+
+/* A period of zero starts every frame right away */
+int CreateFramePacer(FramePacer *&, std::chrono::duration<double> period);
+int DestroyFramePacer(FramePacer *);
+
+/* Blocks until the next frame is due. Reports the time since the start
+ * of the previous frame, and how late this one started. A frame which is
+ * more than a period late drops the missed deadlines, instead of trying
+ * to catch up on them.
+ */
+void WaitForNextFrame(FramePacer *, std::chrono::microseconds *elapsed,
+                      std::chrono::microseconds *late);
+
+/* Lets the next frame start right away, as if one period had passed
+ * since the previous one, e.g. after the loop waited for input
+ */
+void ResetFramePacer(FramePacer *);
+} // namespace fb
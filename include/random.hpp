@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+
+namespace fb {
+/* PCG32 (XSH RR). The 64 bit state is advanced by a linear congruential
+ * step, whose odd increment selects one of 2^63 independent streams.
+ * Consumers drawing from separate streams do not shift each other's
+ * numbers, no matter how many numbers each of them draws.
+ */
+struct Pcg32 {
+  std::uint64_t state{0x853c49e6748fea9bull};
+  std::uint64_t inc{0xda3e39cb94b95bdbull};
+};
+
+/* The streams of the subsystems drawing random numbers */
+namespace stream {
+constexpr std::uint64_t game{0};
+constexpr std::uint64_t fences{1};
+constexpr std::uint64_t rockets{2};
+constexpr std::uint64_t particles{3};
+
+/* The game seeds of the batched environments, one stream each from here */
+constexpr std::uint64_t environments{4};
+} // namespace stream
+
+inline std::uint32_t Next(Pcg32 *g) {
+  const std::uint64_t old = g->state;
+  g->state = old * 6364136223846793005ull + g->inc;
+  const auto xorshifted =
+      static_cast<std::uint32_t>(((old >> 18u) ^ old) >> 27u);
+  const auto rot = static_cast<std::uint32_t>(old >> 59u);
+  return (xorshifted >> rot) | (xorshifted << ((32u - rot) & 31u));
+}
+
+inline void Seed(Pcg32 *g, std::uint64_t seed, std::uint64_t stream) {
+  g->state = 0;
+  g->inc = (stream << 1u) | 1u;
+  Next(g);
+  g->state += seed;
+  Next(g);
+}
+
+/* Draws from [0, bound) without the bias of taking the remainder, by
+ * Lemire's multiply and reject method. A bound of 0 yields 0.
+ */
+inline std::uint32_t NextBelow(Pcg32 *g, std::uint32_t bound) {
+  std::uint64_t m = std::uint64_t{Next(g)} * bound;
+  auto low = static_cast<std::uint32_t>(m);
+  if (low < bound) {
+    const std::uint32_t threshold = -bound % bound;
+    while (low < threshold) {
+      m = std::uint64_t{Next(g)} * bound;
+      low = static_cast<std::uint32_t>(m);
+    }
+  }
+  return static_cast<std::uint32_t>(m >> 32u);
+}
+
+/* Draws from [inclBegin, exclEnd), or yields inclBegin if it is empty */
+inline std::uint32_t NextInRange(Pcg32 *g, std::uint32_t inclBegin,
+                                 std::uint32_t exclEnd) {
+  return exclEnd > inclBegin ? inclBegin + NextBelow(g, exclEnd - inclBegin)
+                             : inclBegin;
+}
+} // namespace fb
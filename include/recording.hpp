@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <simulation.hpp>
+#include <string>
+#include <vector>
+
+namespace fb::sim {
+/* The layout of a recording. A header holding the configuration the world
+ * was reset with is followed by one record per step, made of the input
+ * flags byte and the hash of the world after the step. All values are in
+ * the byte order of the recording machine.
+ */
+namespace rec {
+constexpr char magic[4]{'F', 'B', 'R', 'C'};
+constexpr std::uint32_t version{2};
+constexpr std::uint8_t flap{1};
+
+struct Header {
+  char magic[4];
+  std::uint32_t version;
+  float width, height;
+  float birdWidth, birdHeight;
+  float rocketWidth, rocketHeight;
+  std::uint32_t fenceCount, rocketCount;
+  std::uint32_t seed, reserved;
+  double tick;
+  std::uint64_t count;
+};
+
+static_assert(sizeof(Header) == 64);
+constexpr std::size_t recordSize{5};
+} // namespace rec
+
+/* A game from its reset on, step by step */
+struct Recording {
+  Config config;
+  std::vector<Input> inputs;
+  std::vector<std::uint32_t> hashes;
+};
+
+/* Hashes everything which influences the following steps */
+std::uint32_t Hash(const World &);
+
+/* Resets the world and starts the recording over */
+int Reset(World *, Recording *, const Config &);
+
+/* Steps the world and appends the step to the recording */
+int Step(World *, Recording *, Input);
+
+int WriteRecording(const Recording &, const std::string &path);
+int ReadRecording(Recording *, const std::string &path);
+
+/* Steps a world reset with the recorded configuration through the whole
+ * recording. Fails with Result::Error on the first step whose hash
+ * differs, which is then stored in mismatch.
+ */
+int Replay(const Recording &, World *, std::size_t *mismatch);
+} // namespace fb::sim
@@ -1,11 +1,15 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <memory>
 #include <result.hpp>
 #include <string>
 #include <unordered_map>
 
 namespace fb {
+struct Archive;
+struct ImageCache;
 
 using TextureMap = std::unordered_map<std::string, sf::Texture>;
 using FontMap = std::unordered_map<std::string, sf::Font>;
@@ -14,4 +18,46 @@ int ReadTexture(TextureMap *dst, const std::string &id,
                 const std::string &path);
 int ReadFont(FontMap *dst, const std::string &id, const std::string &path);
 
+/* Read the resource straight from the memory of an archive entry. The
+ * archive has to stay open for as long as the resource is in use.
+ */
+int ReadTexture(TextureMap *dst, const std::string &id, Archive *,
+                const std::string &name);
+int ReadFont(FontMap *dst, const std::string &id, Archive *,
+             const std::string &name);
+
+using TextureHandle = std::shared_ptr<sf::Texture>;
+using FontHandle = std::shared_ptr<sf::Font>;
+
+/* Hands out shared handles to textures and fonts, keyed by the canonical
+ * path of the file they were read from, so that each asset is decoded
+ * only once per process no matter how many scenes use it. An entry stays
+ * cached after its last user lets go of it, so that a scene which is
+ * cleared and built again finds its assets still decoded.
+ */
+struct ResourceCache;
+
+int CreateResourceCache(ResourceCache *&);
+int DestroyResourceCache(ResourceCache *);
+
+/* Makes the cache read any resource present in the archive from there,
+ * instead of from its loose file. The archive has to outlive the cache.
+ */
+int MountArchive(ResourceCache *, Archive *);
+Archive *GetMountedArchive(ResourceCache *);
+
+/* Makes the cache read textures through the image cache, which keeps them
+ * decoded on disk. The image cache has to outlive the cache.
+ */
+int MountImageCache(ResourceCache *, ImageCache *);
+ImageCache *GetMountedImageCache(ResourceCache *);
+
+int AcquireTexture(ResourceCache *, const std::string &path, TextureHandle *);
+int AcquireFont(ResourceCache *, const std::string &path, FontHandle *);
+
+/* Creates the texture of the given path from an already decoded image,
+ * unless the cache holds it already, in which case that one is returned.
+ */
+int StoreTexture(ResourceCache *, const std::string &path, const sf::Image &,
+                 TextureHandle *);
 } // namespace fb
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
 namespace fb {
 struct Application;
 
@@ -7,21 +13,49 @@ struct Scene {
 protected:
   Application *app_{nullptr};
   bool rebuild_{false};
+  bool redraw_{true};
+
+  /* Backs the objects made by build, which come and go with the scene. The
+   * first few kilobytes are part of the scene itself, so that a small
+   * scene is built without touching the heap.
+   */
+  std::pmr::memory_resource *arena() { return &arena_; }
+
+private:
+  alignas(std::max_align_t) std::array<std::byte, 16 * 1024> buffer_;
+  std::pmr::monotonic_buffer_resource arena_{buffer_.data(), buffer_.size()};
 
 public:
   Scene(Application *ptr) : app_{ptr} {}
   virtual ~Scene() = default;
   Scene(const Scene &) = delete;
   Scene &operator=(const Scene &) = delete;
-  Scene(Scene &&) = default;
-  Scene &operator=(Scene &&) = default;
+  Scene(Scene &&) = delete;
+  Scene &operator=(Scene &&) = delete;
 
   virtual int build() = 0;
   virtual int update() = 0;
   virtual int render() = 0;
   virtual int clear() = 0;
 
+  /* The textures read by build. They are decoded in the background
+   * before the scene is built, see PrefetchScene.
+   */
+  virtual std::vector<std::string> dependencies() const { return {}; }
+
   bool requiresRebuild() const { return rebuild_; }
   void requiresRebuild(bool v) { rebuild_ = v; }
+
+  /* Frees everything allocated from the arena at once. Only to be called
+   * after clear, which has to destroy whatever lives in it.
+   */
+  void releaseArena() { arena_.release(); }
+
+  /* Cleared before each render. A scene which looks the same as when it
+   * was last rendered is not rendered again, and while nothing happens
+   * the application waits for input instead of running frames.
+   */
+  bool requiresRedraw() const { return redraw_; }
+  void requiresRedraw(bool v) { redraw_ = v; }
 };
 } // namespace fb
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <collision.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <random.hpp>
+#include <vector>
+
+/* A headless model of the InGame scene. Nothing in here depends on SFML,
+ * so the game logic can be stepped without a window, e.g. in batch jobs.
+ * All coordinates are in window pixels and every body is an axis aligned
+ * rectangle described by its top left corner and its size.
+ */
+namespace fb::sim {
+/* Blends two states of a body, alpha being in the range [0, 1] */
+Rect Interpolate(const Rect &last, const Rect &now, float alpha);
+
+struct Input {
+  bool flap{false};
+};
+
+struct Config {
+  float width{960}, height{540};
+  float birdWidth{80}, birdHeight{60};
+  float rocketWidth{165}, rocketHeight{40};
+  unsigned fenceCount{2};
+  unsigned rocketCount{1};
+  std::uint32_t seed{0};
+
+  /* The duration of a single step in seconds */
+  double tick{1.0 / 60.0};
+};
+
+/* Each body remembers where it was before the most recent step,
+ * so that the view can interpolate between the two states.
+ * Velocities are expressed in pixels per second.
+ */
+struct Bird {
+  Rect body, last;
+  float v{0};
+};
+
+/* The obstacles are stored as parallel arrays, indexed by the obstacle,
+ * so that they are moved in tight loops over contiguous memory. The
+ * vertical direction of a fence is -1 while it rises and 1 while it sinks.
+ */
+struct Fences {
+  std::vector<float> x, y, w, h;
+  std::vector<float> lastX, lastY;
+  std::vector<float> v, dir;
+  std::vector<std::uint8_t> score;
+};
+
+struct Rockets {
+  std::vector<float> x, y, w, h;
+  std::vector<float> lastX, lastY;
+};
+
+std::size_t Count(const Fences &);
+std::size_t Count(const Rockets &);
+Rect GetBody(const Fences &, std::size_t);
+Rect GetLastBody(const Fences &, std::size_t);
+Rect GetBody(const Rockets &, std::size_t);
+Rect GetLastBody(const Rockets &, std::size_t);
+
+struct World {
+  Config config;
+  Bird bird;
+  Fences fences;
+  Rockets rockets;
+
+  /* Seeded from the config, one stream per kind of obstacle */
+  Pcg32 fenceRng, rocketRng;
+
+  /* Rebuilt each step from the fences followed by the rockets */
+  Grid colliders;
+  std::vector<Rect> colliderRects;
+  std::vector<std::uint32_t> hits;
+
+  float rocketPhase{0};
+  unsigned score{0};
+  bool launched{false};
+  bool gameOver{false};
+};
+
+/* Puts the world into the state of a freshly built InGame scene */
+int Reset(World *, const Config &);
+
+/* Advances the world by a single tick of the configured duration */
+int Step(World *, Input);
+} // namespace fb::sim
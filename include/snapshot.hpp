@@ -0,0 +1,64 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <cstddef>
+#include <input.hpp>
+#include <optional>
+#include <variant>
+#include <vector>
+
+namespace fb {
+/* A range of the vertices held by the snapshot, e.g. a flushed batch */
+struct Vertices {
+  std::size_t first{0}, count{0};
+  sf::PrimitiveType type{sf::PrimitiveType::Triangles};
+};
+
+/* The drawables are copied, so that nothing the simulation thread goes on
+ * changing is read while drawing. Textures are only referenced, and text
+ * arrives as vertices, since fonts must not be touched by two threads.
+ */
+struct DrawItem {
+  std::variant<sf::RectangleShape, sf::Sprite, Vertices> drawable;
+  sf::RenderStates states;
+};
+
+/* Everything needed to draw one frame, in drawing order */
+struct Snapshot {
+  std::vector<DrawItem> items;
+  std::vector<sf::Vertex> vertices;
+
+  /* The oldest press shown for the first time in this snapshot */
+  std::optional<InputClock::time_point> press;
+};
+
+void Draw(sf::RenderTarget &, const Snapshot &);
+
+/* Owns the context of the window and draws the most recently published
+ * snapshot on a thread of its own. The snapshots are passed through a
+ * triple buffer, so neither side ever waits for the other: a snapshot
+ * which is replaced before it was drawn is dropped. The events are still
+ * polled on the thread which created the window.
+ */
+struct RenderThread;
+
+int CreateRenderThread(RenderThread *&, sf::RenderWindow *);
+int DestroyRenderThread(RenderThread *);
+
+/* Returns the snapshot to fill next, emptied, which belongs to the caller
+ * until it is published
+ */
+Snapshot *GetBackSnapshot(RenderThread *);
+void PublishSnapshot(RenderThread *);
+
+/* Blocks until every published snapshot was either drawn or dropped, after
+ * which the resources referenced by them may be released
+ */
+void WaitForRenderThread(RenderThread *);
+
+/* Reports the latency of the most recently displayed press, and fails
+ * with Result::NotFound when none was displayed since the previous call
+ */
+int TakeDisplayLatency(RenderThread *, std::chrono::microseconds *);
+} // namespace fb
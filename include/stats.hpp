@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace fb {
+/* The phases of a single iteration of the main loop. Latency is sampled
+ * only on frames which handled a press, from the moment the press was
+ * polled until the frame was displayed. Jitter is how late each frame
+ * started, compared with when it was due.
+ */
+enum class Phase {
+  Frame,
+  Events,
+  Assets,
+  Update,
+  Render,
+  Display,
+  Commands,
+  Latency,
+  Jitter,
+  Count
+};
+
+/* Quantities counted once per frame */
+enum class Counter { DrawCalls, Vertices, Count };
+
+/* Keeps a rolling window of the most recent samples of every phase, and
+ * a histogram of that window, so that percentiles can be read cheaply.
+ */
+struct FrameStats;
+
+struct PhaseSummary {
+  std::size_t samples{0};
+  std::chrono::microseconds p50{}, p95{}, p99{}, max{};
+};
+
+struct CounterSummary {
+  std::size_t samples{0};
+  std::uint64_t p50{0}, p95{0}, p99{0}, max{0};
+};
+
+int CreateFrameStats(FrameStats *&, std::size_t window);
+int DestroyFrameStats(FrameStats *);
+
+void RecordPhase(FrameStats *, Phase, std::chrono::microseconds);
+int GetPhaseSummary(FrameStats *, Phase, PhaseSummary *);
+const char *GetPhaseName(Phase);
+
+void RecordCounter(FrameStats *, Counter, std::uint64_t);
+int GetCounterSummary(FrameStats *, Counter, CounterSummary *);
+const char *GetCounterName(Counter);
+
+/* Writes the summary of every phase, in microseconds, and of every
+ * counter into a CSV file
+ */
+int WriteFrameStats(FrameStats *, const std::string &path);
+
+/* Records the time between its construction and destruction as a phase */
+class PhaseTimer {
+  FrameStats *stats_;
+  Phase phase_;
+  std::chrono::steady_clock::time_point start_;
+
+public:
+  PhaseTimer(FrameStats *s, Phase p)
+      : stats_{s}, phase_{p}, start_{std::chrono::steady_clock::now()} {}
+  ~PhaseTimer() {
+    RecordPhase(stats_, phase_,
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start_));
+  }
+  PhaseTimer(const PhaseTimer &) = delete;
+  PhaseTimer &operator=(const PhaseTimer &) = delete;
+};
+} // namespace fb
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace fb {
+/* A timeline of what every thread did, made of spans, counters and
+ * instant events. Each thread records into a buffer of its own, and the
+ * buffers are written as Chrome trace event JSON, which chrome://tracing
+ * and Perfetto open. Names have to be string literals, or otherwise live
+ * until the trace is written; the optional detail is copied.
+ */
+using TraceClock = std::chrono::steady_clock;
+
+/* Checked before anything is recorded, so that while tracing is off a
+ * span or an event costs a load and a branch
+ */
+inline std::atomic<bool> tracing{false};
+
+inline bool IsTracing() { return tracing.load(std::memory_order_relaxed); }
+void EnableTracing(bool);
+
+/* Shown instead of the thread number in the viewer */
+void SetTraceThreadName(const char *);
+
+void RecordTraceSpan(const char *name, std::string_view detail,
+                     TraceClock::time_point begin,
+                     TraceClock::time_point end);
+void RecordTraceInstant(const char *name, std::string_view detail);
+void RecordTraceCounter(const char *name, std::int64_t value);
+
+inline void TraceInstant(const char *name, std::string_view detail = {}) {
+  if (IsTracing())
+    RecordTraceInstant(name, detail);
+}
+
+inline void TraceCounter(const char *name, std::int64_t value) {
+  if (IsTracing())
+    RecordTraceCounter(name, value);
+}
+
+/* Writes everything recorded so far, by every thread. Recording may go on
+ * meanwhile, and a later call writes the whole trace again.
+ */
+int WriteTrace(const std::string &path);
+
+/* Records the time between its construction and destruction as a span.
+ * The detail has to outlive the span.
+ */
+class TraceSpan {
+  const char *name_{nullptr};
+  std::string_view detail_;
+  TraceClock::time_point begin_;
+
+public:
+  explicit TraceSpan(const char *name, std::string_view detail = {}) {
+    if (IsTracing()) {
+      name_ = name;
+      detail_ = detail;
+      begin_ = TraceClock::now();
+    }
+  }
+  ~TraceSpan() {
+    if (name_)
+      RecordTraceSpan(name_, detail_, begin_, TraceClock::now());
+  }
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+};
+} // namespace fb
@@ -1,118 +1,195 @@
 #include <animation.hpp>
 #include <chrono>
-#include <list>
+#include <memory_resource>
 #include <result.hpp>
+#include <vector>
 
 namespace fb {
 struct Frame {
   int left, top, width, height;
 };
 
-struct Animation {
-  std::chrono::time_point<std::chrono::steady_clock> stamp;
-  std::list<Frame> frames;
-  std::list<FrameSeq> sequences;
-  FrameSeq *activeSeq;
+/* The frames of a sequence occupy [first, first + count) of seqFrames */
+struct FrameSeq {
+  std::chrono::steady_clock::duration duration;
+  int first, count;
 };
 
-struct FrameSeq {
-  std::chrono::milliseconds duration;
-  std::list<Frame *> frames;
-  Frame *activeFrame;
+struct AnimationSystem {
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  explicit AnimationSystem(std::pmr::memory_resource *r)
+      : alloc{r}, frames{r}, sequences{r}, seqFrames{r}, sequence{r},
+        cursor{r}, activeFrame{r}, stamp{r}, paused{r} {}
+
+  std::pmr::polymorphic_allocator<> alloc;
+
+  std::pmr::vector<Frame> frames;
+  std::pmr::vector<FrameSeq> sequences;
+  std::pmr::vector<int> seqFrames;
+
+  /* The state of each animation, indexed by the animation */
+  std::pmr::vector<int> sequence;
+  std::pmr::vector<int> cursor;
+  std::pmr::vector<int> activeFrame;
+  std::pmr::vector<TimePoint> stamp;
+  std::pmr::vector<char> paused;
+
+  TimePoint now;
 };
 
-int AddFrame(Animation *a, Frame *&f, int left, int top, int width,
-             int height) {
-  a->frames.push_back({left, top, width, height});
-  f = &a->frames.back();
-  return Result::Success;
+namespace {
+bool IsValid(int i, std::size_t count) {
+  return i >= 0 && static_cast<std::size_t>(i) < count;
 }
+} // namespace
 
-int CreateAnimation(Animation *&a) {
-  a = new Animation{};
-  if (!a)
-    return Result::Error;
+int CreateAnimationSystem(AnimationSystem *&s,
+                          std::pmr::memory_resource *r) {
+  if (!r)
+    return Result::DomainError;
+  s = std::pmr::polymorphic_allocator<>{r}.new_object<AnimationSystem>(r);
+  s->now = std::chrono::steady_clock::now();
   return Result::Success;
 }
 
-int DestroyAnimation(Animation *a) {
-  delete a;
+int DestroyAnimationSystem(AnimationSystem *s) {
+  if (s)
+    std::pmr::polymorphic_allocator<>{s->alloc}.delete_object(s);
   return Result::Success;
 }
 
-int AddFrameSequence(Animation *a, FrameSeq *&f) {
-  a->sequences.push_back({});
-  f = &a->sequences.back();
+int AddFrame(AnimationSystem *s, int &f, int left, int top, int width,
+             int height) {
+  if (!s)
+    return Result::DomainError;
+  s->frames.push_back({left, top, width, height});
+  f = s->frames.size() - 1;
   return Result::Success;
 }
 
-int AddFrameToSequence(FrameSeq *s, Frame *f) {
-  if (!s->frames.size())
-    s->activeFrame = f;
-  s->frames.push_back(f);
+int AddFrameSequence(AnimationSystem *s, int &seq) {
+  if (!s)
+    return Result::DomainError;
+  s->sequences.push_back({{}, static_cast<int>(s->seqFrames.size()), 0});
+  seq = s->sequences.size() - 1;
   return Result::Success;
 }
 
-int SetFrameDuration(FrameSeq *s, std::chrono::milliseconds d) {
-  s->duration = d;
+int AddFrameToSequence(AnimationSystem *s, int seq, int f) {
+  if (!s || !IsValid(seq, s->sequences.size()) ||
+      !IsValid(f, s->frames.size()))
+    return Result::DomainError;
+
+  /* Keep the frames of every sequence contiguous, which only costs
+   * anything when sequences are not filled in the order they were added.
+   */
+  auto &target = s->sequences[seq];
+  const int at = target.first + target.count;
+  s->seqFrames.insert(s->seqFrames.begin() + at, f);
+  ++target.count;
+  for (auto &&other : s->sequences)
+    if (&other != &target && other.first >= at)
+      ++other.first;
+
+  for (std::size_t i = 0; i < s->sequence.size(); ++i)
+    if (s->sequence[i] >= 0)
+      s->activeFrame[i] =
+          s->seqFrames[s->sequences[s->sequence[i]].first + s->cursor[i]];
+
   return Result::Success;
 }
 
-int SetFrameSequence(Animation *a, FrameSeq *s) {
-  a->activeSeq = s;
+int SetFrameDuration(AnimationSystem *s, int seq,
+                     std::chrono::milliseconds d) {
+  if (!s || !IsValid(seq, s->sequences.size()))
+    return Result::DomainError;
+  s->sequences[seq].duration = d;
   return Result::Success;
 }
 
-int GetFrameDuration(FrameSeq *s, std::chrono::milliseconds *dst) {
-  *dst = s->duration;
+int GetFrameDuration(AnimationSystem *s, int seq,
+                     std::chrono::milliseconds *dst) {
+  if (!s || !IsValid(seq, s->sequences.size()) || !dst)
+    return Result::DomainError;
+  *dst = std::chrono::duration_cast<std::chrono::milliseconds>(
+      s->sequences[seq].duration);
   return Result::Success;
 }
 
-int GetActiveFrame(Animation *a, Frame *&f) {
-  if (!a->activeSeq)
+int CreateAnimation(AnimationSystem *s, int &a) {
+  if (!s)
     return Result::DomainError;
+  s->sequence.push_back(-1);
+  s->cursor.push_back(0);
+  s->activeFrame.push_back(-1);
+  s->stamp.push_back(s->now);
+  s->paused.push_back(false);
+  a = s->sequence.size() - 1;
+  return Result::Success;
+}
 
-  const auto now = std::chrono::steady_clock::now();
-  using ms = std::chrono::milliseconds;
-  ms duration{};
-
-  GetFrameDuration(a->activeSeq, &duration);
-
-  if (std::chrono::duration_cast<ms>(now - a->stamp) > duration) {
-    a->stamp = now;
-    auto &frames = a->activeSeq->frames;
-    auto it = frames.begin();
-    for (; it != frames.end(); ++it)
-      if (*it == a->activeSeq->activeFrame)
-        break;
-    ++it;
-    if (it == frames.end())
-      a->activeSeq->activeFrame = frames.front();
-    else
-      a->activeSeq->activeFrame = *it;
-  }
+int SetFrameSequence(AnimationSystem *s, int a, int seq) {
+  if (!s || !IsValid(a, s->sequence.size()) ||
+      !IsValid(seq, s->sequences.size()))
+    return Result::DomainError;
+  if (!s->sequences[seq].count)
+    return Result::DomainError;
 
-  f = a->activeSeq->activeFrame;
+  s->sequence[a] = seq;
+  s->cursor[a] = 0;
+  s->activeFrame[a] = s->seqFrames[s->sequences[seq].first];
+  s->stamp[a] = s->now;
   return Result::Success;
 }
 
-int GetFrameLeft(Frame *f, int *v) {
-  *v = f->left;
+int SetAnimationPaused(AnimationSystem *s, int a, bool v) {
+  if (!s || !IsValid(a, s->sequence.size()))
+    return Result::DomainError;
+  s->paused[a] = v;
   return Result::Success;
 }
 
-int GetFrameTop(Frame *f, int *v) {
-  *v = f->top;
+int AdvanceAnimations(AnimationSystem *s,
+                      std::chrono::steady_clock::time_point now) {
+  if (!s)
+    return Result::DomainError;
+
+  s->now = now;
+  const std::size_t n = s->sequence.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    if (s->paused[i] || s->sequence[i] < 0)
+      continue;
+
+    const auto &seq = s->sequences[s->sequence[i]];
+    if (now - s->stamp[i] > seq.duration) {
+      s->stamp[i] = now;
+      if (++s->cursor[i] == seq.count)
+        s->cursor[i] = 0;
+      s->activeFrame[i] = s->seqFrames[seq.first + s->cursor[i]];
+    }
+  }
+
   return Result::Success;
 }
 
-int GetFrameWidth(Frame *f, int *v) {
-  *v = f->width;
+int GetActiveFrame(AnimationSystem *s, int a, int &f) {
+  if (!s || !IsValid(a, s->sequence.size()) || s->activeFrame[a] < 0)
+    return Result::DomainError;
+  f = s->activeFrame[a];
   return Result::Success;
 }
 
-int GetFrameHeight(Frame *f, int *v) {
-  *v = f->height;
+int GetFrameRect(AnimationSystem *s, int f, int *left, int *top, int *width,
+                 int *height) {
+  if (!s || !IsValid(f, s->frames.size()))
+    return Result::DomainError;
+
+  const auto &fr = s->frames[f];
+  *left = fr.left;
+  *top = fr.top;
+  *width = fr.width;
+  *height = fr.height;
   return Result::Success;
 }
 } // namespace fb
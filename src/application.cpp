@@ -1,21 +1,42 @@
 #include <SFML/Window/Keyboard.hpp>
+#include <algorithm>
 #include <animation.hpp>
 #include <application.hpp>
+#include <archive.hpp>
+#include <backend.hpp>
+#include <batch.hpp>
 #include <button.hpp>
 #include <chrono>
+#include <command.hpp>
+#include <cmath>
 #include <filesystem>
 #include <functional>
+#include <imagecache.hpp>
+#include <input.hpp>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <label.hpp>
+#include <limits>
 #include <list>
+#include <loader.hpp>
+#include <memory_resource>
+#include <optional>
+#include <pacer.hpp>
 #include <random>
+#include <random.hpp>
 #include <ranges>
+#include <recording.hpp>
 #include <regex>
 #include <resource.hpp>
 #include <result.hpp>
 #include <scene.hpp>
+#include <simulation.hpp>
+#include <sstream>
+#include <stats.hpp>
 #include <string>
 #include <thread>
+#include <trace.hpp>
 #include <vector>
 
 namespace {
@@ -24,20 +45,38 @@ void SetCurrentWorkingDirectory(const char *bin) {
   fs::current_path(fs::absolute(fs::path{bin}.parent_path()));
 }
 
-template <typename T>
-T GetTimeSince(const std::chrono::time_point<std::chrono::steady_clock> &m) {
-  return std::chrono::duration_cast<T>(std::chrono::steady_clock::now() - m);
-}
-
 template <typename T>
 int ExtractParameterValue(int argc, char **argv, std::string regex, T *dst);
 
 int Update(fb::Application *a);
 
-void CreateWindow(fb::Application *a, int c, char **v);
+void HandleEvent(fb::Application *a, const sf::Event &e);
+
+void RenderStatsOverlay(fb::Application *a);
+
+int CreateRenderBackend(fb::Application *a, int c, char **v);
+
+int BuildScene(fb::Application *a, const std::string &name);
 } // namespace
 
 namespace fb {
+/* Shown while the dependencies of the deferred scene are decoded in the
+ * background, after which it moves on to that scene.
+ */
+struct Loading : public Scene {
+public:
+  Loading(Application *ptr) : Scene(ptr) {}
+  int build() override;
+  int update() override;
+  int render() override;
+  int clear() override;
+
+private:
+  FontHandle font_;
+  std::optional<sf::Text> text_;
+  sf::RectangleShape frame_, bar_;
+};
+
 struct MainMenu : public Scene {
 public:
   MainMenu(Application *ptr) : Scene(ptr) {}
@@ -47,47 +86,40 @@ public:
   int clear() override;
 
 private:
-  std::list<Button> buttons_;
-  FontMap fonts_;
+  /* In the arena, so it only lives between build and clear */
+  std::optional<std::pmr::list<Button>> buttons_;
+  std::unique_ptr<ButtonLayer, int (*)(ButtonLayer *)> layer_{
+      nullptr, DestroyButtonLayer};
+  FontHandle font_;
+
+  /* The menu only changes when a button does, so it is rendered into the
+   * canvas then, and the canvas is what each frame shows
+   */
+  sf::RenderTexture canvas_;
+  std::optional<sf::Sprite> canvasSprite_;
+  bool canvasStale_{true};
 };
 
 struct Bird : public sf::Drawable {
-  std::unique_ptr<fb::Animation, int (*)(Animation *)> animation;
-  std::unique_ptr<sf::Sprite> body;
+  int animation{-1};
+  std::optional<sf::Sprite> body;
 
   void draw(sf::RenderTarget &r, sf::RenderStates s) const override {
     r.draw(*body, s);
   }
 
-  Bird() : animation{nullptr, fb::DestroyAnimation} {}
-
-  void update(Application *, bool animate);
-};
-
-struct Fence : public sf::Drawable {
-  sf::RectangleShape body;
-  float up_{1};
-  float v_{2};
-  bool score_{true};
-
-  void update(Application *, unsigned maxSpeed);
-
-  void draw(sf::RenderTarget &r, sf::RenderStates s) const override {
-    r.draw(body, s);
-  }
+  void update(AnimationSystem *);
 };
 
 struct Rocket : public sf::Drawable {
-  std::unique_ptr<fb::Animation, int (*)(Animation *)> animation;
-  std::unique_ptr<sf::Sprite> body;
+  int animation{-1};
+  std::optional<sf::Sprite> body;
 
   void draw(sf::RenderTarget &r, sf::RenderStates s) const override {
     r.draw(*body, s);
   }
 
-  Rocket() : animation{nullptr, fb::DestroyAnimation} {}
-
-  void update(Application *, bool animate);
+  void update(AnimationSystem *);
 };
 
 struct InGame : public Scene {
@@ -98,94 +130,301 @@ public:
   int render() override;
   int clear() override;
 
-  unsigned scoreCount_{0};
-  Button *score_;
+  std::vector<std::string> dependencies() const override {
+    return {"./img/BirdSprite.png", "./img/projectile.png"};
+  }
 
 private:
-  std::list<Button> buttons_;
-  std::list<Fence> fences_;
-  std::list<Rocket> rockets_;
-  TextureMap textures_;
-  FontMap fonts_;
-
+  Button *score_;
+  NumberLabel scoreLabel_;
+
+  /* The buttons, rockets and animations are in the arena, so they only
+   * live between build and clear
+   */
+  std::optional<std::pmr::list<Button>> buttons_;
+  std::unique_ptr<ButtonLayer, int (*)(ButtonLayer *)> layer_{
+      nullptr, DestroyButtonLayer};
+  std::optional<std::pmr::list<Rocket>> rockets_;
+  TextureHandle birdTexture_, fireballTexture_;
+  FontHandle font_;
+
+  std::unique_ptr<AnimationSystem, int (*)(AnimationSystem *)> animations_{
+      nullptr, DestroyAnimationSystem};
   Bird bird_;
 
-  bool gameOver_{false};
-  bool launch_{false};
-
-  const float dv_{9.81};
-  float v_{0};
+  /* The view above only mirrors this state, the game logic lives here */
+  sim::World world_;
+  std::size_t replayStep_{0};
+  bool diverged_{false};
 
   sf::RectangleShape bg_;
 };
 
 struct Application {
+  /* Declared first, so that they outlive the scenes holding their handles.
+   * The resources may be read straight out of the mapped archive memory.
+   */
+  std::unique_ptr<Archive, int (*)(Archive *)> archive{nullptr, CloseArchive};
+  std::unique_ptr<ImageCache, int (*)(ImageCache *)> images{
+      nullptr, DestroyImageCache};
+  std::unique_ptr<ResourceCache, int (*)(ResourceCache *)> resources{
+      nullptr, DestroyResourceCache};
+  std::unique_ptr<AssetLoader, int (*)(AssetLoader *)> loader{
+      nullptr, DestroyAssetLoader};
+
   std::unordered_map<std::string, std::unique_ptr<Scene>> scenes;
 
-  sf::RenderWindow window;
+  /* The window, possibly drawn by a render thread, or with --headless
+   * nothing but a record of the draws. Declared after the scenes, so that
+   * it is gone before the textures they hold.
+   */
+  std::unique_ptr<RenderBackend, int (*)(RenderBackend *)> backend{
+      nullptr, DestroyRenderBackend};
 
   Scene *active;
 
-  /* The minimum duration of processing one frame */
-  std::chrono::milliseconds minTPF;
+  /* Set when the previous frame had nothing to show, in which case the
+   * next one waits for an event, for at most idleTimeout
+   */
+  bool idle{false};
+  std::chrono::milliseconds idleTimeout{100};
 
-  /* The processing time of the previous frame */
-  std::chrono::milliseconds elapsed;
-
-  sf::Vector2f mousePos;
-
-  bool primaryMouseButtonPressed{false};
-  bool buttonClicked{false};
-  bool buttonHovered{false};
-  bool flapRequested{false};
-
-  using Command = std::function<void(Application *)>;
-  std::list<Command> commandQ;
+  /* Starts the frames, one every --time-per-frame or --frame-rate */
+  std::unique_ptr<FramePacer, int (*)(FramePacer *)> pacer{nullptr,
+                                                           DestroyFramePacer};
 
-  static inline std::mt19937 rng{std::random_device{}()};
+  /* The processing time of the previous frame */
+  std::chrono::microseconds elapsed;
+
+  /* The simulation advances in ticks of a fixed duration, independent of
+   * the framerate. The accumulator holds the time which has not been
+   * simulated yet, and at most maxTicksPerFrame ticks are run per frame
+   * to catch up. Whatever is left over is used to blend the last two
+   * simulated states when rendering.
+   */
+  std::chrono::duration<double> tick;
+  std::chrono::duration<double> accumulator{};
+  unsigned maxTicksPerFrame;
+  float alpha{0};
+
+  /* The number of dependencies still being decoded, per scene for which
+   * they were requested, and the scene waiting behind the loading screen
+   */
+  std::unordered_map<std::string, std::size_t> pending;
+  const char *deferred{nullptr};
+
+  /* With --record, the most recent game is written to recordPath on exit.
+   * With --replay, InGame is driven by the replay instead of the player,
+   * and with --unthrottled every frame runs exactly one tick.
+   */
+  sim::Recording recording, replay;
+  std::string recordPath;
+  bool replaying{false};
+  bool unthrottled{false};
+
+  /* Fed by the events polled each frame, and read by the scenes a tick
+   * at a time
+   */
+  std::unique_ptr<InputQueue, int (*)(InputQueue *)> input{
+      nullptr, DestroyInputQueue};
+  std::unique_ptr<CommandQueue, int (*)(CommandQueue *)> commandQ{
+      nullptr, DestroyCommandQueue};
+
+  /* The timings of each phase of the main loop. They are dumped to
+   * statsPath on exit, and shown on screen while showStats is set.
+   */
+  std::unique_ptr<FrameStats, int (*)(FrameStats *)> stats{nullptr,
+                                                           DestroyFrameStats};
+  std::string statsPath;
+  bool showStats{false};
+  unsigned statsFrame{0};
+  std::unique_ptr<sf::Text> statsText;
+  FontHandle statsFont;
+
+  /* With --trace, the timeline of every thread is written to tracePath on
+   * exit, and whenever F4 is pressed
+   */
+  std::string tracePath;
+
+  /* Shared by the scenes, and counted into the stats once per frame */
+  std::unique_ptr<SpriteBatch, int (*)(SpriteBatch *)> batch{
+      nullptr, DestroySpriteBatch};
+  std::uint64_t drawCalls{0}, vertices{0};
+
+  /* Seeded with --seed, or randomly when it is not given */
+  Pcg32 rng;
 };
 
 int Initialize(Application *&app, int argc, char **argv) {
   SetCurrentWorkingDirectory(argv[0]);
   app = new Application{};
 
-  unsigned tpf = 16; // This translates to about 60 FPS
+  if (ExtractParameterValue(argc, argv, "--trace", &app->tracePath) ==
+      Result::Success)
+    EnableTracing(true);
+  SetTraceThreadName("main");
+  TraceSpan span{"initialize"};
+
+  std::uint64_t seed = std::random_device{}();
+  ExtractParameterValue(argc, argv, "--seed", &seed);
+  Seed(&app->rng, seed, stream::game);
+
+  /* 16ms translates to about 60 FPS. Both may be fractional, and the
+   * frame rate takes precedence, e.g. --frame-rate 144
+   */
+  double tpf = 16, fps = 0;
   ExtractParameterValue(argc, argv, "--time-per-frame|-t", &tpf);
-  app->minTPF =
-      std::chrono::milliseconds{tpf}; // This controls the framerate
-                                      // by specifying that the minimum
-                                      // frame duration should be 17ms
+  ExtractParameterValue(argc, argv, "--frame-rate", &fps);
+  FramePacer *pacer{nullptr};
+  if (auto r = CreateFramePacer(pacer, std::chrono::duration<double>{
+                                           fps > 0 ? 1.0 / fps : tpf / 1e3});
+      r != Result::Success) {
+    LogErr("Failed to create the frame pacer with error code: ", r);
+    return r;
+  }
+  app->pacer.reset(pacer);
 
-  CreateWindow(app, argc, argv);
+  unsigned tickRate = 60;
+  ExtractParameterValue(argc, argv, "--tick-rate|-r", &tickRate);
+  app->tick = std::chrono::duration<double>{1.0 / (tickRate ? tickRate : 60)};
 
+  app->maxTicksPerFrame = 5;
+  ExtractParameterValue(argc, argv, "--max-ticks-per-frame",
+                        &app->maxTicksPerFrame);
+  /* With none, the game would never advance */
+  app->maxTicksPerFrame = std::max(app->maxTicksPerFrame, 1u);
+
+  ResourceCache *resources{nullptr};
+  if (auto r = CreateResourceCache(resources); r != Result::Success) {
+    LogErr("Failed to create the resource cache with error code: ", r);
+    return r;
+  }
+  app->resources.reset(resources);
+
+  /* Without the archive the assets are read from the loose files */
+  if (Archive *ar{nullptr};
+      OpenArchive(ar, "./assets.pak") == Result::Success) {
+    app->archive.reset(ar);
+    MountArchive(resources, ar);
+  }
+
+  /* Textures decoded once are kept in --image-cache, unless it is empty,
+   * so that later runs skip the decoding
+   */
+  std::string cacheDir{"./cache"};
+  ExtractParameterValue(argc, argv, "--image-cache", &cacheDir);
+  if (ImageCache *images{nullptr};
+      !cacheDir.empty() &&
+      CreateImageCache(images, cacheDir) == Result::Success) {
+    app->images.reset(images);
+    MountImageCache(resources, images);
+  }
+
+  AssetLoader *loader{nullptr};
+  const unsigned threads =
+      std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+  if (auto r = CreateAssetLoader(loader, resources, threads);
+      r != Result::Success) {
+    LogErr("Failed to create the asset loader with error code: ", r);
+    return r;
+  }
+  app->loader.reset(loader);
+
+  FrameStats *stats{nullptr};
+  if (auto r = CreateFrameStats(stats, 600); r != Result::Success) {
+    LogErr("Failed to create frame statistics with error code: ", r);
+    return r;
+  }
+  app->stats.reset(stats);
+
+  SpriteBatch *batch{nullptr};
+  if (auto r = CreateSpriteBatch(batch, app); r != Result::Success) {
+    LogErr("Failed to create the sprite batch with error code: ", r);
+    return r;
+  }
+  app->batch.reset(batch);
+
+  InputQueue *input{nullptr};
+  if (auto r = CreateInputQueue(input); r != Result::Success) {
+    LogErr("Failed to create the input queue with error code: ", r);
+    return r;
+  }
+  app->input.reset(input);
+
+  CommandQueue *commands{nullptr};
+  if (auto r = CreateCommandQueue(commands, 256); r != Result::Success) {
+    LogErr("Failed to create the command queue with error code: ", r);
+    return r;
+  }
+  app->commandQ.reset(commands);
+
+  unsigned overlay = 0;
+  ExtractParameterValue(argc, argv, "--overlay", &overlay);
+  app->showStats = overlay;
+  ExtractParameterValue(argc, argv, "--stats", &app->statsPath);
+
+  ExtractParameterValue(argc, argv, "--record", &app->recordPath);
+  if (std::string path;
+      ExtractParameterValue(argc, argv, "--replay", &path) == Result::Success) {
+    if (auto r = sim::ReadRecording(&app->replay, path); r != Result::Success) {
+      LogErr("Failed to read the replay with error code: ", r);
+      return r;
+    }
+    app->replaying = true;
+  }
+  unsigned unthrottled = 0;
+  ExtractParameterValue(argc, argv, "--unthrottled", &unthrottled);
+  app->unthrottled = unthrottled;
+
+  if (auto r = CreateRenderBackend(app, argc, argv); r != Result::Success) {
+    LogErr("Failed to create the render backend with error code: ", r);
+    return r;
+  }
+
+  app->scenes.emplace("Loading", new Loading{app});
   app->scenes.emplace("MainMenu", new MainMenu{app});
   app->scenes.emplace("InGame", new InGame{app});
 
+  /* The scenes are built on first use, or once prefetched */
   for (auto &&s : app->scenes)
-    if (auto r = s.second->build(); r != Result::Success) {
-      auto msg = "Failed to build scene: " + s.first + " with error code: ";
-      LogErr(msg.c_str(), r);
-      return r;
-    }
+    s.second->requiresRebuild(true);
 
-  ScheduleSceneTransition(app, "MainMenu");
+  ScheduleSceneTransition(app, app->replaying ? "InGame" : "MainMenu");
   return Result::Success;
 }
 
 int Run(Application *a) {
-  auto p = std::chrono::steady_clock::now();
+  ResetFramePacer(a->pacer.get());
+
+  while (a->backend->isOpen()) {
+    /* The wait is not part of any frame, so it is left out of the stats
+     * and the simulation goes on as if a single frame had passed
+     */
+    if (a->idle) {
+      TraceSpan span{"idle"};
+      if (auto event = a->backend->waitEvent(a->idleTimeout))
+        HandleEvent(a, *event);
+      a->idle = false;
+      ResetFramePacer(a->pacer.get());
+    }
 
-  while (a->window.isOpen()) {
-    if (auto e = GetTimeSince<decltype(a->minTPF)>(p); e < a->minTPF) {
-      std::this_thread::sleep_for(std::chrono::microseconds{100});
-      continue;
-    } else
-      a->elapsed = e;
-    p = std::chrono::steady_clock::now();
+    std::chrono::microseconds late{};
+    {
+      TraceSpan span{"pace"};
+      WaitForNextFrame(a->pacer.get(), &a->elapsed, &late);
+    }
+    RecordPhase(a->stats.get(), Phase::Frame, a->elapsed);
+    RecordPhase(a->stats.get(), Phase::Jitter, late);
 
-    while (auto event = a->window.pollEvent())
-      if (event->is<sf::Event::Closed>())
-        a->window.close();
+    {
+      PhaseTimer t{a->stats.get(), Phase::Events};
+      while (auto event = a->backend->pollEvent())
+        HandleEvent(a, *event);
+    }
+
+    /* Closed by one of the events, so there is nothing to draw to */
+    if (!a->backend->isOpen())
+      break;
 
     if (auto r = Update(a); r != Result::Success) {
       LogErr("The main update function failed with error code: ", r);
@@ -196,9 +435,44 @@ int Run(Application *a) {
   return Result::Success;
 }
 
-void Destroy(Application *a) { delete a; }
+void Destroy(Application *a) {
+  if (a && !a->tracePath.empty())
+    if (auto r = WriteTrace(a->tracePath); r != Result::Success)
+      LogErr("Failed to write the trace with error code: ", r);
+  if (a && a->stats && !a->statsPath.empty())
+    if (auto r = WriteFrameStats(a->stats.get(), a->statsPath);
+        r != Result::Success)
+      LogErr("Failed to write frame statistics with error code: ", r);
+  if (a && !a->recordPath.empty())
+    if (auto r = sim::WriteRecording(a->recording, a->recordPath);
+        r != Result::Success)
+      LogErr("Failed to write the recording with error code: ", r);
+  delete a;
+}
+
+void Render(Application *a, const sf::Text *t) {
+  FlushSpriteBatch(a->batch.get());
+  a->backend->draw(*t);
+  ++a->drawCalls;
+}
+
+void Render(Application *a, const sf::RectangleShape *r) {
+  FlushSpriteBatch(a->batch.get());
+  a->backend->draw(*r);
+  ++a->drawCalls;
+}
+
+void Render(Application *a, const sf::Sprite *s) {
+  FlushSpriteBatch(a->batch.get());
+  a->backend->draw(*s);
+  ++a->drawCalls;
+}
 
-void Render(Application *a, sf::Drawable *d) { a->window.draw(*d); }
+void Render(Application *a, const sf::VertexArray &v, const sf::Texture *t) {
+  a->backend->draw(v, t);
+  ++a->drawCalls;
+  a->vertices += v.getVertexCount();
+}
 
 void LogErr(const char *m, int n) {
   std::cerr << "(ERR): " << m << n << std::endl;
@@ -207,120 +481,318 @@ void LogErr(const char *m, int n) {
 void LogErr(const char *m) { std::cerr << "(ERR): " << m << std::endl; }
 
 double GetFrameTimeInSeconds(Application *a) {
-  auto e = std::chrono::duration_cast<std::chrono::milliseconds>(a->elapsed);
-  auto secPerMs = 0.001;
-  return e.count() * secPerMs;
+  return std::chrono::duration<double>{a->elapsed}.count();
 }
 
-float GetMousePositionX(Application *a) { return a->mousePos.x; }
-float GetMousePositionY(Application *a) { return a->mousePos.y; }
-float GetWindowSizeX(Application *a) { return a->window.getSize().x; }
-float GetWindowSizeY(Application *a) { return a->window.getSize().y; }
+double GetTickDurationInSeconds(Application *a) { return a->tick.count(); }
 
-bool IsPrimaryMouseButtonPressed(Application *a) {
-  return a->primaryMouseButtonPressed;
-}
-void SetButtonClicked(Application *a, bool v) { a->buttonClicked = v; }
-bool IsButtonClicked(Application *a) { return a->buttonClicked; }
-void SetButtonHovered(Application *a, bool v) { a->buttonHovered = v; }
-bool IsButtonHovered(Application *a) { return a->buttonHovered; }
+float GetInterpolationFactor(Application *a) { return a->alpha; }
 
-void IncrementScore(Application *a) {
-  auto scene = dynamic_cast<InGame *>(a->scenes.at("InGame").get());
-  scene->score_->text->setString("Score: " +
-                                 std::to_string(++scene->scoreCount_));
-}
+float GetWindowSizeX(Application *a) { return a->backend->getSize().x; }
+float GetWindowSizeY(Application *a) { return a->backend->getSize().y; }
+ResourceCache *GetResourceCache(Application *a) { return a->resources.get(); }
+AssetLoader *GetAssetLoader(Application *a) { return a->loader.get(); }
 
-unsigned GetScore(Application *a) {
-  auto scene = dynamic_cast<InGame *>(a->scenes.at("InGame").get());
-  return scene->scoreCount_;
-}
+SpriteBatch *GetSpriteBatch(Application *a) { return a->batch.get(); }
+
+CommandQueue *GetCommandQueue(Application *a) { return a->commandQ.get(); }
+
+InputQueue *GetInputQueue(Application *a) { return a->input.get(); }
+
+void FinishPresentedFrames(Application *a) { a->backend->finish(); }
 
 unsigned GetRandomNumber(Application *a, unsigned inclBegin, unsigned exclEnd) {
-  return inclBegin + a->rng() % exclEnd;
+  return NextInRange(&a->rng, inclBegin, exclEnd);
 }
 
-bool IsFlapRequested(Application *) {
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Space))
-    return true;
-  return false;
+bool IsFlapRequested(Application *a) {
+  return IsDown(a->input.get(), Control::Flap) ||
+         WasPressed(a->input.get(), Control::Flap);
 }
 
 void ScheduleExit(Application *a) {
-  a->commandQ.push_back([](Application *app) { app->window.close(); });
+  if (PostCommand(a->commandQ.get(),
+                  [](Application *app) { app->backend->close(); }) !=
+      Result::Success)
+    LogErr("The command queue is full, dropped: exit");
 }
 
 void ScheduleSceneTransition(Application *a, const char *scene) {
-  a->commandQ.push_back([scene](Application *app) {
-    auto target = app->scenes.at(scene).get();
-    if (target->requiresRebuild()) {
-      target->build();
-      target->requiresRebuild(false);
+  const auto r = PostCommand(a->commandQ.get(), [scene](Application *app) {
+    const char *name = scene;
+    if (!IsSceneReady(app, name)) {
+      PrefetchScene(app, name);
+      app->deferred = name;
+      name = "Loading";
     }
-    app->active = target;
-    app->primaryMouseButtonPressed = false;
-    app->buttonClicked = false;
-    app->buttonHovered = false;
+
+    BuildScene(app, name);
+    TraceInstant("transition", name);
+    app->active = app->scenes.at(name).get();
+    app->active->requiresRedraw(true);
+    app->accumulator = {};
   });
+  if (r != Result::Success)
+    LogErr("The command queue is full, dropped: scene transition");
 }
 
 void ScheduleSceneClear(Application *app) {
-  if (app->active)
-    app->commandQ.push_back([](Application *a) {
-      a->active->clear();
-      a->active->requiresRebuild(true);
-    });
+  if (!app->active)
+    return;
+  if (PostCommand(app->commandQ.get(),
+                  [](Application *a) {
+                    /* The frames in flight may still use its textures */
+                    FinishPresentedFrames(a);
+                    TraceSpan span{"clear"};
+                    a->active->clear();
+                    a->active->releaseArena();
+                    a->active->requiresRebuild(true);
+                  }) != Result::Success)
+    LogErr("The command queue is full, dropped: scene clear");
+}
+
+void PrefetchScene(Application *a, const char *scene) {
+  if (a->pending.contains(scene))
+    return;
+
+  const auto deps = a->scenes.at(scene)->dependencies();
+  a->pending[scene] = deps.size();
+  for (auto &&path : deps) {
+    auto done = [a, name = std::string{scene}](int r, TextureHandle) {
+      if (r != Result::Success)
+        LogErr("Failed to decode a scene dependency with error code: ", r);
+      if (--a->pending.at(name) == 0)
+        BuildScene(a, name);
+    };
+    if (auto r = RequestTexture(a->loader.get(), path, done);
+        r != Result::Success) {
+      LogErr("Failed to request a texture with error code: ", r);
+      --a->pending.at(scene);
+    }
+  }
+}
+
+bool IsSceneReady(Application *a, const char *scene) {
+  if (auto it = a->pending.find(scene); it != a->pending.end())
+    return it->second == 0;
+  return a->scenes.at(scene)->dependencies().empty();
 }
 } // namespace fb
 
 namespace {
-void CreateWindow(fb::Application *a, int c, char **v) {
-  const auto d = sf::VideoMode::getDesktopMode();
+int BuildScene(fb::Application *a, const std::string &name) {
+  auto &s = a->scenes.at(name);
+  if (!s->requiresRebuild())
+    return fb::Result::Success;
+
+  /* Laying out its text may add glyphs to a font the frames in flight
+   * are drawn with
+   */
+  fb::FinishPresentedFrames(a);
+  fb::TraceSpan span{"build", name};
+  if (auto r = s->build(); r != fb::Result::Success) {
+    auto msg = "Failed to build scene: " + name + " with error code: ";
+    fb::LogErr(msg.c_str(), r);
+    return r;
+  }
+  s->requiresRebuild(false);
+  return fb::Result::Success;
+}
+
+int CreateRenderBackend(fb::Application *a, int c, char **v) {
+  unsigned headless = 0, renderThread = 0;
+  std::string log;
+  ExtractParameterValue(c, v, "--headless", &headless);
+  ExtractParameterValue(c, v, "--render-thread", &renderThread);
+  if (ExtractParameterValue(c, v, "--render-log", &log) == fb::Result::Success)
+    headless = 1;
+
+  /* Without a display there is no desktop to fit the window into */
+  const auto d = headless ? sf::VideoMode{{~0u, ~0u}}
+                          : sf::VideoMode::getDesktopMode();
   sf::Vector2u s{960, 540};
   unsigned w, h;
   ExtractParameterValue(c, v, "--width|-w", &w);
   ExtractParameterValue(c, v, "--height|-h", &h);
   sf::VideoMode m{
       {w > s.x && w <= d.size.x ? w : s.x, h > s.y && h < d.size.y ? h : s.y}};
-  a->window.create(m, "Flappy Bird", sf::Style::Close);
+
+  fb::RenderBackend *b{nullptr};
+  if (auto r = headless ? fb::CreateRecordingBackend(b, m.size, log)
+                        : fb::CreateWindowBackend(b, m, renderThread);
+      r != fb::Result::Success)
+    return r;
+  a->backend.reset(b);
+  return fb::Result::Success;
 }
 
-void UpdateMouseInfo(fb::Application *a) {
-  if (sf::Mouse::isButtonPressed(sf::Mouse::Button::Left))
-    a->primaryMouseButtonPressed = true;
-  else
-    a->primaryMouseButtonPressed = false;
+void HandleEvent(fb::Application *a, const sf::Event &e) {
+  fb::FeedEvent(a->input.get(), e, fb::InputClock::now());
+  if (e.is<sf::Event::Closed>()) {
+    a->backend->close();
+  } else if (auto k = e.getIf<sf::Event::KeyPressed>();
+             k && k->code == sf::Keyboard::Key::F3) {
+    a->showStats = !a->showStats;
+    if (a->active)
+      a->active->requiresRedraw(true);
+  } else if (k && k->code == sf::Keyboard::Key::F4 && !a->tracePath.empty()) {
+    if (auto r = fb::WriteTrace(a->tracePath); r != fb::Result::Success)
+      fb::LogErr("Failed to write the trace with error code: ", r);
+  } else if (e.is<sf::Event::FocusGained>() || e.is<sf::Event::Resized>()) {
+    /* What was shown may have been lost in the meantime */
+    if (a->active)
+      a->active->requiresRedraw(true);
+  }
+}
 
-  const auto mPos = sf::Mouse::getPosition(a->window);
-  a->mousePos.x = mPos.x;
-  a->mousePos.y = mPos.y;
+void DrainCommands(fb::Application *a) {
+  fb::PhaseTimer t{a->stats.get(), fb::Phase::Commands};
+  fb::TraceSpan span{"commands"};
+  fb::DrainCommandQueue(a->commandQ.get(), a);
 }
 
 int Update(fb::Application *a) {
-  UpdateMouseInfo(a);
+  fb::TraceSpan span{"frame"};
+  auto stats = a->stats.get();
+
+  {
+    fb::PhaseTimer t{stats, fb::Phase::Assets};
+    fb::TraceSpan span{"assets"};
+    if (auto r = fb::PumpAssetLoader(a->loader.get()); r != fb::Result::Success)
+      fb::LogErr("Failed to finish loading an asset with error code: ", r);
+  }
 
   if (fb::Scene *s = a->active; s && !s->requiresRebuild()) {
-    if (auto r = s->update(); r != fb::Result::Success) {
-      fb::LogErr("Failed to update active scene with error code: ", r);
-      return r;
+    if (a->unthrottled)
+      a->accumulator = a->tick;
+    else
+      a->accumulator += a->elapsed;
+
+    unsigned ticks{0};
+    {
+      fb::PhaseTimer t{stats, fb::Phase::Update};
+      for (; a->accumulator >= a->tick; ++ticks) {
+        if (ticks == a->maxTicksPerFrame) {
+          a->accumulator = std::chrono::duration<double>{
+              std::fmod(a->accumulator.count(), a->tick.count())};
+          break;
+        }
+
+        fb::BeginTick(a->input.get());
+        fb::TraceSpan span{"update"};
+        if (auto r = s->update(); r != fb::Result::Success) {
+          fb::LogErr("Failed to update active scene with error code: ", r);
+          return r;
+        }
+        a->accumulator -= a->tick;
+      }
+      a->alpha = a->accumulator / a->tick;
     }
 
-    a->window.clear();
-    if (auto r = s->render(); r != fb::Result::Success) {
-      fb::LogErr("Failed to render active scene with error code: ", r);
-      return r;
+    /* A press which changed nothing on screen has no latency to speak of */
+    if (!s->requiresRedraw() && !a->showStats) {
+      std::chrono::microseconds l{};
+      fb::TakeInputLatency(a->input.get(), fb::InputClock::now(), &l);
+
+      DrainCommands(a);
+
+      /* A command may have switched to another scene. Input which no tick
+       * has seen yet keeps the loop going until the next tick applies it.
+       */
+      std::size_t done{0}, total{0};
+      fb::GetAssetLoaderProgress(a->loader.get(), &done, &total);
+      a->idle = ticks && !fb::HasPendingInput(a->input.get()) &&
+                done == total && !a->active->requiresRedraw();
+      return fb::Result::Success;
     }
-    a->window.display();
-  }
 
-  for (auto &&cmd : a->commandQ)
-    if (cmd)
-      cmd(a);
-  a->commandQ.clear();
+    {
+      fb::PhaseTimer t{stats, fb::Phase::Render};
+      fb::TraceSpan span{"render"};
+      a->backend->begin();
+      a->drawCalls = a->vertices = 0;
+      s->requiresRedraw(false);
+      if (auto r = s->render(); r != fb::Result::Success) {
+        fb::LogErr("Failed to render active scene with error code: ", r);
+        return r;
+      }
+      fb::FlushSpriteBatch(a->batch.get());
+      fb::RecordCounter(stats, fb::Counter::DrawCalls, a->drawCalls);
+      fb::RecordCounter(stats, fb::Counter::Vertices, a->vertices);
+      fb::TraceCounter("draw calls", a->drawCalls);
+      fb::TraceCounter("vertices", a->vertices);
+      RenderStatsOverlay(a);
+    }
 
+    {
+      fb::PhaseTimer t{stats, fb::Phase::Display};
+      fb::TraceSpan span{"present"};
+      const auto now = fb::InputClock::now();
+      std::optional<fb::InputClock::time_point> press;
+      if (std::chrono::microseconds l{};
+          fb::TakeInputLatency(a->input.get(), now, &l) == fb::Result::Success)
+        press = now - l;
+      a->backend->present(press);
+    }
+
+    if (std::chrono::microseconds l{};
+        a->backend->takeLatency(&l) == fb::Result::Success)
+      fb::RecordPhase(stats, fb::Phase::Latency, l);
+  }
+
+  DrainCommands(a);
   return fb::Result::Success;
 }
 
+void RenderStatsOverlay(fb::Application *a) {
+  if (!a->showStats)
+    return;
+
+  if (!a->statsText) {
+    if (auto r = fb::AcquireFont(a->resources.get(), "./font/ExoRegular.ttf",
+                                 &a->statsFont);
+        r != fb::Result::Success) {
+      fb::LogErr("Failed to read the overlay font with error code: ", r);
+      a->showStats = false;
+      return;
+    }
+    a->statsText = std::make_unique<sf::Text>(*a->statsFont);
+    a->statsText->setCharacterSize(14);
+    a->statsText->setFillColor(sf::Color::White);
+    a->statsText->setPosition({8.f, 8.f});
+    a->statsFrame = 0;
+  }
+
+  /* Rebuilding the text is costly, so it is refreshed every 30 frames */
+  if (a->statsFrame++ % 30 == 0) {
+    std::ostringstream out;
+    out << std::left << std::setw(10) << "us" << std::right << std::setw(8)
+        << "p50" << std::setw(8) << "p95" << std::setw(8) << "p99"
+        << std::setw(8) << "max" << '\n';
+    for (int i = 0; i < static_cast<int>(fb::Phase::Count); ++i) {
+      const auto p = static_cast<fb::Phase>(i);
+      fb::PhaseSummary ps{};
+      fb::GetPhaseSummary(a->stats.get(), p, &ps);
+      out << std::left << std::setw(10) << fb::GetPhaseName(p) << std::right
+          << std::setw(8) << ps.p50.count() << std::setw(8) << ps.p95.count()
+          << std::setw(8) << ps.p99.count() << std::setw(8) << ps.max.count()
+          << '\n';
+    }
+    out << '\n' << std::left << std::setw(10) << "count" << '\n';
+    for (int i = 0; i < static_cast<int>(fb::Counter::Count); ++i) {
+      const auto c = static_cast<fb::Counter>(i);
+      fb::CounterSummary cs{};
+      fb::GetCounterSummary(a->stats.get(), c, &cs);
+      out << std::left << std::setw(10) << fb::GetCounterName(c) << std::right
+          << std::setw(8) << cs.p50 << std::setw(8) << cs.p95 << std::setw(8)
+          << cs.p99 << std::setw(8) << cs.max << '\n';
+    }
+    a->statsText->setString(out.str());
+  }
+
+  fb::Render(a, a->statsText.get());
+}
+
 template <typename T>
 int ExtractParameterValue(int argc, char **argv, std::string regex, T *dst) {
   const std::regex query{regex};
@@ -387,9 +859,9 @@ void UpdateButton(
   };
 };
 
-void UpdateButtonText(auto &fonts, fb::Button *b, std::string f, sf::Color tc,
+void UpdateButtonText(const sf::Font &f, fb::Button *b, sf::Color tc,
                       unsigned cs, std::string l) {
-  b->text = std::unique_ptr<sf::Text>{new sf::Text{fonts.at(f)}};
+  b->text.emplace(f);
   b->text->setCharacterSize(cs);
   b->text->setFillColor(tc);
   b->text->setString(l);
@@ -399,31 +871,107 @@ void UpdateButtonText(auto &fonts, fb::Button *b, std::string f, sf::Color tc,
 } // namespace
 
 namespace fb {
+int Loading::build() {
+  if (auto r = AcquireFont(GetResourceCache(app_), "./font/ExoRegular.ttf",
+                           &font_);
+      r != Result::Success) {
+    LogErr("Failed to read font: ExoRegular");
+    return r;
+  }
+
+  const sf::Vector2f sz = {GetWindowSizeX(app_) * 0.6f, 30.f};
+  const sf::Vector2f pos = {(GetWindowSizeX(app_) - sz.x) / 2.f,
+                            GetWindowSizeY(app_) / 2.f};
+
+  frame_.setSize(sz);
+  frame_.setPosition(pos);
+  frame_.setFillColor(sf::Color::Transparent);
+  frame_.setOutlineColor(sf::Color(204, 51, 153));
+  frame_.setOutlineThickness(2.f);
+
+  bar_.setSize({0.f, sz.y});
+  bar_.setPosition(pos);
+  bar_.setFillColor(sf::Color(204, 51, 153));
+
+  text_.emplace(*font_);
+  text_->setCharacterSize(50);
+  text_->setFillColor(sf::Color::White);
+  text_->setString("Loading");
+  text_->setPosition(
+      {(GetWindowSizeX(app_) - text_->getLocalBounds().size.x) / 2.f,
+       pos.y - 2.f * text_->getLocalBounds().size.y});
+
+  return Result::Success;
+}
+
+int Loading::update() {
+  std::size_t done{0}, total{0};
+  GetAssetLoaderProgress(GetAssetLoader(app_), &done, &total);
+  const sf::Vector2f bar{
+      frame_.getSize().x * (total ? float(done) / total : 1.f),
+      frame_.getSize().y};
+  if (bar != bar_.getSize()) {
+    bar_.setSize(bar);
+    requiresRedraw(true);
+  }
+
+  if (app_->deferred && IsSceneReady(app_, app_->deferred)) {
+    ScheduleSceneTransition(app_, app_->deferred);
+    app_->deferred = nullptr;
+  }
+  return Result::Success;
+}
+
+int Loading::render() {
+  Render(app_, &frame_);
+  Render(app_, &bar_);
+  Render(app_, &*text_);
+  return Result::Success;
+}
+
+int Loading::clear() {
+  text_.reset();
+  font_.reset();
+  return Result::Success;
+}
+
 int MainMenu::render() {
-  for (auto &&b : buttons_)
-    Render(app_, &b);
+  if (canvasStale_) {
+    /* The frames in flight may still show the canvas */
+    FinishPresentedFrames(app_);
+    canvas_.clear(sf::Color::Transparent);
+    for (auto &&b : *buttons_)
+      canvas_.draw(b);
+    canvas_.display();
+    canvasStale_ = false;
+  }
+
+  Render(app_, &*canvasSprite_);
   return Result::Success;
 }
 
 int MainMenu::update() {
-  for (auto it = buttons_.end(); true;) {
-    --it;
-    if (it != buttons_.end())
-      it->update(app_);
-    if (it == buttons_.begin())
-      break;
+  if (UpdateButtons(layer_.get(), app_)) {
+    canvasStale_ = true;
+    requiresRedraw(true);
   }
   return Result::Success;
 }
 
 int MainMenu::clear() {
-  buttons_.clear();
-  fonts_.clear();
+  canvasSprite_.reset();
+  canvas_ = sf::RenderTexture{};
+  canvasStale_ = true;
+  if (layer_)
+    ClearButtons(layer_.get());
+  buttons_.reset();
+  font_.reset();
   return Result::Success;
 }
 
 int MainMenu::build() {
-  if (auto r = ReadFont(&fonts_, "ExoRegular", "./font/ExoRegular.ttf");
+  if (auto r = AcquireFont(GetResourceCache(app_), "./font/ExoRegular.ttf",
+                           &font_);
       r != Result::Success) {
     LogErr("Failed to read font: ExoRegular");
     return r;
@@ -435,134 +983,156 @@ int MainMenu::build() {
 
   const sf::Color ic(204, 51, 153), hc(230, 76, 178), cc(153, 0, 102);
   const unsigned cs = 100;
-  std::string mainF = "ExoRegular";
 
-  auto play = CreateButton(buttons_, pos, sz);
+  buttons_.emplace(arena());
+  auto play = CreateButton(*buttons_, pos, sz);
   UpdateButton(play, ic, hc, cc,
                [](auto *a, auto *) { ScheduleSceneTransition(a, "InGame"); });
-  UpdateButtonText(fonts_, play, mainF, sf::Color::Black, cs, "Play");
+  UpdateButtonText(*font_, play, sf::Color::Black, cs, "Play");
 
-  auto exit = CreateButton(buttons_, {-sz.x, vshift}, sz, play);
+  auto exit = CreateButton(*buttons_, {-sz.x, vshift}, sz, play);
   UpdateButton(exit, ic, hc, cc, [](auto *a, auto *) { ScheduleExit(a); });
-  UpdateButtonText(fonts_, exit, mainF, sf::Color::Black, cs, "Exit");
+  UpdateButtonText(*font_, exit, sf::Color::Black, cs, "Exit");
+
+  /* Kept across rebuilds, only its buttons are cleared along with the
+   * scene
+   */
+  if (!layer_) {
+    ButtonLayer *layer{nullptr};
+    if (auto r = CreateButtonLayer(layer); r != Result::Success) {
+      LogErr("Failed to create the button layer with error code: ", r);
+      return r;
+    }
+    layer_.reset(layer);
+  }
+  for (auto &&b : *buttons_)
+    AddButton(layer_.get(), &b);
 
+  if (!canvas_.resize({static_cast<unsigned>(GetWindowSizeX(app_)),
+                       static_cast<unsigned>(GetWindowSizeY(app_))})) {
+    LogErr("Failed to create the canvas of the main menu");
+    return Result::Error;
+  }
+  canvasSprite_.emplace(canvas_.getTexture());
+  canvasStale_ = true;
+
+  /* Most likely the next scene, so it is warmed up while the menu shows */
+  PrefetchScene(app_, "InGame");
   return Result::Success;
 }
 } // namespace fb
 
 namespace fb {
 int InGame::render() {
-  Render(app_, &bg_);
-  for (auto &&f : fences_)
-    Render(app_, &f);
-  for (auto &&r : rockets_)
-    Render(app_, &r);
-  Render(app_, bird_.body.get());
-  for (auto &&b : buttons_)
-    Render(app_, &b);
+  const float alpha = GetInterpolationFactor(app_);
+
+  AdvanceAnimations(animations_.get(), std::chrono::steady_clock::now());
+  bird_.update(animations_.get());
+  for (auto &&r : *rockets_)
+    r.update(animations_.get());
+
+  /* The bird sprite is mirrored, so its origin lies on the right edge */
+  const auto bb = sim::Interpolate(world_.bird.last, world_.bird.body, alpha);
+  bird_.body->setPosition({bb.x + bb.w, bb.y});
+
+  auto rit = rockets_->begin();
+  for (std::size_t i = 0; i < sim::Count(world_.rockets); ++i) {
+    const auto body =
+        sim::Interpolate(sim::GetLastBody(world_.rockets, i),
+                         sim::GetBody(world_.rockets, i), alpha);
+    (rit++)->body->setPosition({body.x, body.y});
+  }
+
+  /* The buttons do not overlap, so their boxes go into one batch */
+  auto batch = GetSpriteBatch(app_);
+  Draw(batch, bg_);
+  for (std::size_t i = 0; i < sim::Count(world_.fences); ++i) {
+    const auto body = sim::Interpolate(sim::GetLastBody(world_.fences, i),
+                                       sim::GetBody(world_.fences, i), alpha);
+    Draw(batch, sf::FloatRect{{body.x, body.y}, {body.w, body.h}},
+         sf::Color::Magenta);
+  }
+  for (auto &&r : *rockets_)
+    Draw(batch, *r.body);
+  Draw(batch, *bird_.body);
+  for (auto &&b : *buttons_)
+    Draw(batch, b.box);
+  for (auto &&b : *buttons_)
+    if (b.text)
+      Render(app_, &*b.text);
+  Render(app_, &scoreLabel_);
+
+  /* Animated and interpolated, so no two frames look the same */
+  requiresRedraw(true);
   return Result::Success;
 }
 
 int InGame::update() {
-  for (auto it = buttons_.end(); true;) {
-    --it;
-    if (it != buttons_.end())
-      it->update(app_);
-    if (it == buttons_.begin())
-      break;
-  }
+  UpdateButtons(layer_.get(), app_);
 
-  bird_.update(app_, !gameOver_);
-
-  if (IsFlapRequested(app_))
-    launch_ = true;
-
-  if (launch_ && !gameOver_) {
-    auto b = bird_.body.get();
-    if (b) {
-      v_ += dv_ * GetFrameTimeInSeconds(app_);
-      b->move({0, v_});
-    }
-
-    if (IsFlapRequested(app_)) {
-      v_ -= 0.5;
-    }
-
-    for (auto &&f : fences_) {
-      if (auto bb = f.body.getGlobalBounds();
-          bb.findIntersection(bird_.body->getGlobalBounds())) {
-        gameOver_ = true;
-        break;
-      }
-
-      f.update(app_, bird_.body->getGlobalBounds().size.x);
-
-      if (bird_.body->getPosition().x >
-          f.body.getPosition().x +
-              3.f / 2.f * bird_.body->getGlobalBounds().size.x)
-        if (f.score_) {
-          IncrementScore(app_);
-          f.score_ = false;
-        }
+  sim::Input in{};
+  if (!app_->replaying) {
+    in.flap = IsFlapRequested(app_);
+  } else if (replayStep_ < app_->replay.inputs.size()) {
+    in = app_->replay.inputs[replayStep_];
+  } else {
+    /* Moved past the end, so that the exit is posted only once */
+    if (replayStep_ == app_->replay.inputs.size()) {
+      ScheduleExit(app_);
+      ++replayStep_;
     }
+    return Result::Success;
+  }
 
-    if (GetScore(app_) > 10) {
-      for (auto &&r : rockets_) {
-        r.update(app_, !gameOver_);
-        if (auto bb = r.body->getGlobalBounds();
-            bb.findIntersection(bird_.body->getGlobalBounds())) {
-          gameOver_ = true;
-          break;
-        }
+  const auto r = app_->recordPath.empty()
+                     ? sim::Step(&world_, in)
+                     : sim::Step(&world_, &app_->recording, in);
+  if (r != Result::Success) {
+    LogErr("Failed to step the simulation with error code: ", r);
+    return r;
+  }
 
-        const auto ww = fb::GetWindowSizeX(app_), wh = fb::GetWindowSizeY(app_);
-        if (r.body->getPosition().x < -r.body->getGlobalBounds().size.x)
-          r.body->setPosition(
-              {ww * 2 + fb::GetRandomNumber(app_, 0, ww), wh / 2.f});
-        else {
-          static float prevPos = 0, inc = 6.28 / 1800.f;
-          r.body->move({-5, 0});
-          r.body->setPosition(
-              {r.body->getPosition().x,
-               fb::GetWindowSizeY(app_) / 2.f +
-                   std::sin(prevPos) * fb::GetWindowSizeY(app_) * 0.4f});
-          prevPos += inc;
-          if (prevPos > 6.28)
-            prevPos = 0;
-        }
-      }
-    }
+  if (app_->replaying &&
+      sim::Hash(world_) != app_->replay.hashes[replayStep_++] && !diverged_) {
+    LogErr("The replay diverged at step: ", replayStep_ - 1);
+    diverged_ = true;
+  }
 
-    const auto bb = bird_.body->getGlobalBounds();
-    const auto p = bird_.body->getPosition();
+  scoreLabel_.set(world_.score);
 
-    if (p.y < 0 || p.y > GetWindowSizeY(app_) - bb.size.y)
-      gameOver_ = true;
-  }
+  const bool rocketsActive =
+      world_.launched && world_.score > 10 && !world_.gameOver;
+  SetAnimationPaused(animations_.get(), bird_.animation, world_.gameOver);
+  for (auto &&r : *rockets_)
+    SetAnimationPaused(animations_.get(), r.animation, !rocketsActive);
 
   return Result::Success;
 }
 
 int InGame::clear() {
-  buttons_.clear();
-  textures_.clear();
-  rockets_.clear();
-  fonts_.clear();
-  fences_.clear();
+  if (layer_)
+    ClearButtons(layer_.get());
+  buttons_.reset();
+  birdTexture_.reset();
+  fireballTexture_.reset();
+  rockets_.reset();
+  font_.reset();
   score_ = nullptr;
-  scoreCount_ = 0;
+  scoreLabel_ = {};
   bird_ = {};
-  launch_ = false;
-  gameOver_ = false;
-  v_ = 0;
+  animations_.reset();
+  world_ = {};
+  replayStep_ = 0;
+  diverged_ = false;
   return Result::Success;
 }
 } // namespace fb
 
 namespace {
-int CreateInGameUI(fb::Application *app_, auto &fonts_, auto &buttons_,
-                   auto &score_, auto &bg_) {
-  if (auto r = fb::ReadFont(&fonts_, "ExoRegular", "./font/ExoRegular.ttf");
+int CreateInGameUI(fb::Application *app_, auto &font_, auto &buttons_,
+                   auto &score_, auto &scoreLabel_, auto &bg_) {
+  if (auto r = fb::AcquireFont(fb::GetResourceCache(app_),
+                               "./font/ExoRegular.ttf", &font_);
       r != fb::Result::Success) {
     fb::LogErr("Failed to read font: ExoRegular");
     return r;
@@ -573,18 +1143,19 @@ int CreateInGameUI(fb::Application *app_, auto &fonts_, auto &buttons_,
 
   const sf::Color ic(204, 51, 153), hc(230, 76, 178), cc(153, 0, 102);
   const unsigned cs = 50;
-  std::string mainF = "ExoRegular";
 
   auto back = CreateButton(buttons_, pos, sz);
   UpdateButton(back, ic, hc, cc, [](auto *a, auto *) {
     ScheduleSceneClear(a);
     ScheduleSceneTransition(a, "MainMenu");
   });
-  UpdateButtonText(fonts_, back, mainF, sf::Color::Black, cs, "Back");
+  UpdateButtonText(*font_, back, sf::Color::Black, cs, "Back");
 
   score_ = CreateButton(buttons_, {50.f, -sz.y}, {400.f, sz.y}, back);
   score_->box.setFillColor(ic);
-  UpdateButtonText(fonts_, score_, mainF, sf::Color::Black, cs, "Score: 0");
+  scoreLabel_.build(*font_, cs, sf::Color::Black, "Score: ");
+  scoreLabel_.setPosition(score_->box.getPosition() +
+                          score_->box.getSize() / 2.f);
 
   bg_.setSize({fb::GetWindowSizeX(app_), fb::GetWindowSizeY(app_)});
   bg_.setFillColor(sf::Color{75, 0, 130, 255});
@@ -592,45 +1163,35 @@ int CreateInGameUI(fb::Application *app_, auto &fonts_, auto &buttons_,
   return fb::Result::Success;
 }
 
-int CreateInGameBird(fb::Application *app_, auto &textures_, auto &bird) {
-  if (auto r =
-          fb::ReadTexture(&textures_, "BirdSprite", "./img/BirdSprite.png");
+int CreateInGameBird(fb::Application *app_, auto &texture_,
+                     fb::AnimationSystem *animations, auto &bird) {
+  if (auto r = fb::AcquireTexture(fb::GetResourceCache(app_),
+                                  "./img/BirdSprite.png", &texture_);
       r != fb::Result::Success) {
     fb::LogErr("Failed to read bird sprite texture!");
     return r;
   }
 
-  fb::Animation *animation{nullptr};
-  fb::CreateAnimation(animation);
-  bird.animation = std::unique_ptr<fb::Animation, int (*)(fb::Animation *)>{
-      animation, fb::DestroyAnimation};
-
-  fb::Frame *f1, *f2, *f3, *f4, *f5, *f6, *f7, *f8;
-  fb::AddFrame(animation, f1, 0, 200, 160, 120);
-  fb::AddFrame(animation, f2, 160, 200, 160, 120);
-  fb::AddFrame(animation, f3, 320, 210, 160, 80);
-  fb::AddFrame(animation, f4, 480, 190, 160, 100);
-  fb::AddFrame(animation, f5, 640, 170, 160, 120);
-  fb::AddFrame(animation, f6, 800, 180, 160, 100);
-  fb::AddFrame(animation, f7, 960, 200, 160, 80);
-  fb::AddFrame(animation, f8, 1120, 200, 160, 110);
-
-  fb::FrameSeq *fly;
-  fb::AddFrameSequence(animation, fly);
-  fb::AddFrameToSequence(fly, f1);
-  fb::AddFrameToSequence(fly, f2);
-  fb::AddFrameToSequence(fly, f3);
-  fb::AddFrameToSequence(fly, f4);
-  fb::AddFrameToSequence(fly, f5);
-  fb::AddFrameToSequence(fly, f6);
-  fb::AddFrameToSequence(fly, f7);
-  fb::AddFrameToSequence(fly, f8);
-
-  fb::SetFrameSequence(animation, fly);
-  fb::SetFrameDuration(fly, std::chrono::milliseconds{100});
-
-  bird.body =
-      std::unique_ptr<sf::Sprite>{new sf::Sprite{textures_.at("BirdSprite")}};
+  int f1, f2, f3, f4, f5, f6, f7, f8;
+  fb::AddFrame(animations, f1, 0, 200, 160, 120);
+  fb::AddFrame(animations, f2, 160, 200, 160, 120);
+  fb::AddFrame(animations, f3, 320, 210, 160, 80);
+  fb::AddFrame(animations, f4, 480, 190, 160, 100);
+  fb::AddFrame(animations, f5, 640, 170, 160, 120);
+  fb::AddFrame(animations, f6, 800, 180, 160, 100);
+  fb::AddFrame(animations, f7, 960, 200, 160, 80);
+  fb::AddFrame(animations, f8, 1120, 200, 160, 110);
+
+  int fly;
+  fb::AddFrameSequence(animations, fly);
+  for (int f : {f1, f2, f3, f4, f5, f6, f7, f8})
+    fb::AddFrameToSequence(animations, fly, f);
+  fb::SetFrameDuration(animations, fly, std::chrono::milliseconds{100});
+
+  fb::CreateAnimation(animations, bird.animation);
+  fb::SetFrameSequence(animations, bird.animation, fly);
+
+  bird.body.emplace(*texture_);
   bird.body->setTextureRect({{0, 200}, {160, 120}});
   if (fb::GetWindowSizeX(app_) < 1920)
     bird.body->scale({-0.5f, 0.5f});
@@ -643,61 +1204,36 @@ int CreateInGameBird(fb::Application *app_, auto &textures_, auto &bird) {
   return fb::Result::Success;
 }
 
-int CreateInGameFences(fb::Application *app_, auto &fences_) {
-  const auto wh = fb::GetWindowSizeY(app_);
-  for (std::size_t i = 0; i < 2; ++i) {
-    fences_.push_back({});
-    auto b = &fences_.back().body;
-    b->setSize(
-        {50, wh - fb::GetRandomNumber(app_, 160 * 1.5f, 2.f / 3.f * wh)});
-    b->setFillColor(sf::Color::Magenta);
-    b->setPosition(
-        {fb::GetWindowSizeX(app_) + i * (fb::GetWindowSizeX(app_) / 2.f),
-         fb::GetRandomNumber(app_, 0, 2)
-             ? 0
-             : fb::GetWindowSizeY(app_) - b->getSize().y});
-    fences_.back().up_ = (i % 2);
-  }
-
-  return fb::Result::Success;
-}
-
-int CreateInGameRockets(fb::Application *app_, auto &textures_,
-                        auto &rockets_) {
-  if (auto r = fb::ReadTexture(&textures_, "Fireball", "./img/projectile.png");
+int CreateInGameRockets(fb::Application *app_, auto &texture_,
+                        fb::AnimationSystem *animations, auto &rockets_) {
+  if (auto r = fb::AcquireTexture(fb::GetResourceCache(app_),
+                                  "./img/projectile.png", &texture_);
       r != fb::Result::Success) {
     fb::LogErr("Failed to read Fireball sprite sheet with error code: ", r);
     return r;
   }
 
+  int f1, f2, f3, f4, f5;
+  fb::AddFrame(animations, f1, 60, 645, 330, 80);
+  fb::AddFrame(animations, f2, 455, 645, 350, 80);
+  fb::AddFrame(animations, f3, 860, 640, 360, 80);
+  fb::AddFrame(animations, f4, 1270, 640, 360, 80);
+  fb::AddFrame(animations, f5, 1680, 640, 365, 80);
+
+  int fly;
+  fb::AddFrameSequence(animations, fly);
+  for (int f : {f1, f2, f3, f4, f5})
+    fb::AddFrameToSequence(animations, fly, f);
+  fb::SetFrameDuration(animations, fly, std::chrono::milliseconds{100});
+
   for (unsigned i = 0; i < 1; ++i) {
     rockets_.push_back({});
     auto r = &rockets_.back();
-    fb::Animation *animation{nullptr};
-    fb::CreateAnimation(animation);
-    r->animation = std::unique_ptr<fb::Animation, int (*)(fb::Animation *)>{
-        animation, fb::DestroyAnimation};
-
-    fb::Frame *f1, *f2, *f3, *f4, *f5;
-    fb::AddFrame(animation, f1, 60, 645, 330, 80);
-    fb::AddFrame(animation, f2, 455, 645, 350, 80);
-    fb::AddFrame(animation, f3, 860, 640, 360, 80);
-    fb::AddFrame(animation, f4, 1270, 640, 360, 80);
-    fb::AddFrame(animation, f5, 1680, 640, 365, 80);
-
-    fb::FrameSeq *fly;
-    fb::AddFrameSequence(animation, fly);
-    fb::AddFrameToSequence(fly, f1);
-    fb::AddFrameToSequence(fly, f2);
-    fb::AddFrameToSequence(fly, f3);
-    fb::AddFrameToSequence(fly, f4);
-    fb::AddFrameToSequence(fly, f5);
-
-    fb::SetFrameSequence(animation, fly);
-    fb::SetFrameDuration(fly, std::chrono::milliseconds{100});
-
-    r->body =
-        std::unique_ptr<sf::Sprite>{new sf::Sprite{textures_.at("Fireball")}};
+    fb::CreateAnimation(animations, r->animation);
+    fb::SetFrameSequence(animations, r->animation, fly);
+    fb::SetAnimationPaused(animations, r->animation, true);
+
+    r->body.emplace(*texture_);
     r->body->setPosition(
         {fb::GetWindowSizeX(app_) * (i + 1), 250.f + 150.f * i});
     r->body->setTextureRect({{60, 645}, {330, 80}});
@@ -712,81 +1248,94 @@ int CreateInGameRockets(fb::Application *app_, auto &textures_,
 } // namespace
 
 namespace fb {
-void Rocket::update(Application *, bool animate) {
-  if (animation && animate) {
-    Frame *af{nullptr};
-    GetActiveFrame(animation.get(), af);
-    sf::IntRect r{};
-    if (af) {
-      GetFrameLeft(af, &r.position.x);
-      GetFrameTop(af, &r.position.y);
-      GetFrameWidth(af, &r.size.x);
-      GetFrameHeight(af, &r.size.y);
-      body->setTextureRect(r);
-    }
-  }
+namespace {
+void UpdateTextureRect(AnimationSystem *s, int animation, sf::Sprite *body) {
+  int f{-1};
+  sf::IntRect r{};
+  if (GetActiveFrame(s, animation, f) == Result::Success &&
+      GetFrameRect(s, f, &r.position.x, &r.position.y, &r.size.x,
+                   &r.size.y) == Result::Success &&
+      r != body->getTextureRect())
+    body->setTextureRect(r);
 }
+} // namespace
 
-void Bird::update(Application *, bool animate) {
-  if (animation && animate) {
-    Frame *af{nullptr};
-    GetActiveFrame(animation.get(), af);
-    sf::IntRect r{};
-    if (af) {
-      GetFrameLeft(af, &r.position.x);
-      GetFrameTop(af, &r.position.y);
-      GetFrameWidth(af, &r.size.x);
-      GetFrameHeight(af, &r.size.y);
-      body->setTextureRect(r);
-    }
-  }
+void Rocket::update(AnimationSystem *s) {
+  if (body)
+    UpdateTextureRect(s, animation, &*body);
 }
 
-void Fence::update(Application *app, unsigned maxSpeed) {
-  if (body.getPosition().x > -body.getSize().x) {
-    body.move({-v_, 0});
-    if (GetScore(app) >= 5) {
-      body.move({0, up_ ? -2.f : 2.f});
-      if (body.getPosition().y <= 0 && up_)
-        up_ = false;
-      if (body.getPosition().y >= GetWindowSizeY(app) - body.getSize().y &&
-          !up_)
-        up_ = true;
-    }
-  } else {
-    const float wh = fb::GetWindowSizeY(app);
-    body.setSize({50, (200.f / 540.f) * wh});
-    body.setPosition({GetWindowSizeX(app), (float)fb::GetRandomNumber(
-                                               app, 0, wh - body.getSize().y)});
-    score_ = true;
-  }
-
-  if (v_ < maxSpeed)
-    v_ += GetFrameTimeInSeconds(app) * 0.1;
+void Bird::update(AnimationSystem *s) {
+  if (body)
+    UpdateTextureRect(s, animation, &*body);
 }
 
 int InGame::build() {
-  if (auto r = CreateInGameUI(app_, fonts_, buttons_, score_, bg_);
+  buttons_.emplace(arena());
+  rockets_.emplace(arena());
+
+  AnimationSystem *animations{nullptr};
+  if (auto r = CreateAnimationSystem(animations, arena());
+      r != Result::Success) {
+    LogErr("Failed to create the animation system with error code: ", r);
+    return r;
+  }
+  animations_.reset(animations);
+
+  if (auto r =
+          CreateInGameUI(app_, font_, *buttons_, score_, scoreLabel_, bg_);
       r != Result::Success) {
     LogErr("Failed to create InGame UI with error code: ", r);
     return r;
   }
 
-  if (auto r = CreateInGameBird(app_, textures_, bird_); r != Result::Success) {
+  if (!layer_) {
+    ButtonLayer *layer{nullptr};
+    if (auto r = CreateButtonLayer(layer); r != Result::Success) {
+      LogErr("Failed to create the button layer with error code: ", r);
+      return r;
+    }
+    layer_.reset(layer);
+  }
+  for (auto &&b : *buttons_)
+    AddButton(layer_.get(), &b);
+
+  if (auto r = CreateInGameBird(app_, birdTexture_, animations, bird_);
+      r != Result::Success) {
     LogErr("Failed to create bird with error code: ", r);
     return r;
   }
 
-  if (auto r = CreateInGameFences(app_, fences_); r != Result::Success) {
-    LogErr("Failed to create fences with error code: ", r);
+  if (auto r =
+          CreateInGameRockets(app_, fireballTexture_, animations, *rockets_);
+      r != Result::Success) {
+    LogErr("Failed to create rockets with error code: ", r);
     return r;
   }
 
-  if (auto r = CreateInGameRockets(app_, textures_, rockets_);
+  sim::Config cfg{};
+  cfg.width = GetWindowSizeX(app_);
+  cfg.height = GetWindowSizeY(app_);
+  cfg.birdWidth = bird_.body->getGlobalBounds().size.x;
+  cfg.birdHeight = bird_.body->getGlobalBounds().size.y;
+  cfg.rocketCount = rockets_->size();
+  if (!rockets_->empty()) {
+    cfg.rocketWidth = rockets_->front().body->getGlobalBounds().size.x;
+    cfg.rocketHeight = rockets_->front().body->getGlobalBounds().size.y;
+  }
+  cfg.seed = GetRandomNumber(app_, 0, std::numeric_limits<unsigned>::max());
+  cfg.tick = GetTickDurationInSeconds(app_);
+  if (app_->replaying)
+    cfg = app_->replay.config;
+
+  if (auto r = app_->recordPath.empty()
+                   ? sim::Reset(&world_, cfg)
+                   : sim::Reset(&world_, &app_->recording, cfg);
       r != Result::Success) {
-    LogErr("Failed to create rockets with error code: ", r);
+    LogErr("Failed to reset the simulation with error code: ", r);
     return r;
   }
+
   return Result::Success;
 }
 } // namespace fb
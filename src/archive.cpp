@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <archive.hpp>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <result.hpp>
+#include <string_view>
+
+#if defined(_WIN32)
+#include <fstream>
+#include <vector>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fb {
+struct Archive {
+  const std::byte *data{nullptr};
+  std::size_t size{0};
+  const pak::Entry *entries{nullptr};
+  std::size_t count{0};
+  std::int64_t mtime{0};
+#if defined(_WIN32)
+  std::vector<std::byte> buffer;
+#endif
+};
+
+namespace {
+int Map(Archive *a, const std::string &path) {
+#if defined(_WIN32)
+  std::ifstream in{path, std::ios::binary | std::ios::ate};
+  if (!in)
+    return Result::NotFound;
+  a->buffer.resize(static_cast<std::size_t>(in.tellg()));
+  in.seekg(0);
+  if (!in.read(reinterpret_cast<char *>(a->buffer.data()), a->buffer.size()))
+    return Result::ReadError;
+  a->data = a->buffer.data();
+  a->size = a->buffer.size();
+#else
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return Result::NotFound;
+
+  struct stat st{};
+  if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    return Result::ReadError;
+  }
+
+  void *p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED)
+    return Result::ReadError;
+
+  a->data = static_cast<const std::byte *>(p);
+  a->size = st.st_size;
+#endif
+  return Result::Success;
+}
+
+void Unmap(Archive *a) {
+#if !defined(_WIN32)
+  if (a->data)
+    ::munmap(const_cast<std::byte *>(a->data), a->size);
+#endif
+  a->data = nullptr;
+  a->size = 0;
+}
+
+int Validate(Archive *a) {
+  if (a->size < sizeof(pak::Header))
+    return Result::SyntaxError;
+
+  pak::Header h;
+  std::memcpy(&h, a->data, sizeof(h));
+  if (std::memcmp(h.magic, pak::magic, sizeof(h.magic)) ||
+      h.version != pak::version)
+    return Result::SyntaxError;
+
+  if ((a->size - sizeof(h)) / sizeof(pak::Entry) < h.count)
+    return Result::SyntaxError;
+
+  a->entries = reinterpret_cast<const pak::Entry *>(a->data + sizeof(h));
+  a->count = h.count;
+
+  for (std::size_t i = 0; i < a->count; ++i) {
+    const auto &e = a->entries[i];
+    if (!std::memchr(e.name, '\0', sizeof(e.name)) || e.offset > a->size ||
+        e.size > a->size - e.offset)
+      return Result::SyntaxError;
+  }
+
+  return Result::Success;
+}
+} // namespace
+
+int OpenArchive(Archive *&a, const std::string &path) {
+  a = new Archive{};
+
+  auto r = Map(a, path);
+  if (r == Result::Success)
+    r = Validate(a);
+  if (r == Result::Success) {
+    std::error_code ec;
+    const auto t = std::filesystem::last_write_time(path, ec);
+    a->mtime = ec ? 0 : t.time_since_epoch().count();
+  }
+
+  if (r != Result::Success) {
+    if (r != Result::NotFound)
+      std::cerr << "(ERR): The archive: '" << path << "' is not valid!"
+                << std::endl;
+    CloseArchive(a);
+    a = nullptr;
+  }
+
+  return r;
+}
+
+int CloseArchive(Archive *a) {
+  if (a)
+    Unmap(a);
+  delete a;
+  return Result::Success;
+}
+
+int FindArchiveEntry(Archive *a, const std::string &name, const void **data,
+                     std::size_t *size) {
+  if (!a || !data || !size)
+    return Result::DomainError;
+
+  const auto end = a->entries + a->count;
+  const auto it = std::lower_bound(
+      a->entries, end, name, [](const pak::Entry &e, const std::string &n) {
+        return std::string_view{e.name} < n;
+      });
+  if (it == end || std::string_view{it->name} != name)
+    return Result::NotFound;
+
+  *data = a->data + it->offset;
+  *size = it->size;
+  return Result::Success;
+}
+
+std::int64_t GetArchiveModificationTime(Archive *a) {
+  return a ? a->mtime : 0;
+}
+
+std::string GetArchiveEntryName(const std::string &path) {
+  return std::filesystem::path{path}.lexically_normal().generic_string();
+}
+} // namespace fb
@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <array>
+#include <backend.hpp>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <label.hpp>
+#include <memory>
+#include <result.hpp>
+#include <set>
+#include <snapshot.hpp>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+namespace fb {
+namespace {
+struct WindowBackend : public RenderBackend {
+  WindowBackend(sf::VideoMode m) {
+    window.create(m, "Flappy Bird", sf::Style::Close);
+  }
+
+  bool isOpen() const override { return window.isOpen(); }
+  void close() override { window.close(); }
+  sf::Vector2u getSize() const override { return window.getSize(); }
+  std::optional<sf::Event> pollEvent() override { return window.pollEvent(); }
+  /* A zero timeout would wait for good */
+  std::optional<sf::Event> waitEvent(std::chrono::milliseconds t) override {
+    return window.waitEvent(sf::milliseconds(static_cast<std::int32_t>(
+        std::max<std::chrono::milliseconds::rep>(t.count(), 1))));
+  }
+
+  void begin() override { window.clear(); }
+  void draw(const sf::Text &t) override { window.draw(t); }
+  void draw(const sf::RectangleShape &r) override { window.draw(r); }
+  void draw(const sf::Sprite &s) override { window.draw(s); }
+  void draw(const sf::VertexArray &v, const sf::Texture *t) override {
+    window.draw(v, sf::RenderStates{t});
+  }
+
+  void present(std::optional<InputClock::time_point> press) override {
+    window.display();
+    if (press)
+      latency = std::chrono::duration_cast<std::chrono::microseconds>(
+          InputClock::now() - *press);
+  }
+
+  int takeLatency(std::chrono::microseconds *dst) override {
+    if (!dst)
+      return Result::DomainError;
+    if (!latency)
+      return Result::NotFound;
+    *dst = *std::exchange(latency, std::nullopt);
+    return Result::Success;
+  }
+
+  sf::RenderWindow window;
+  std::optional<std::chrono::microseconds> latency;
+};
+
+/* Collects each frame into a snapshot, drawn by the render thread */
+struct ThreadedBackend : public WindowBackend {
+  using WindowBackend::WindowBackend;
+
+  /* The render thread has to let go of the context first */
+  void close() override {
+    thread.reset();
+    window.close();
+  }
+
+  /* Once closed there is no thread left to hand the frames to */
+  void begin() override {
+    snapshot = thread ? GetBackSnapshot(thread.get()) : nullptr;
+  }
+
+  /* Laid out into vertices here, so that the render thread only reads the
+   * texture of the font. A glyph met for the first time is added to that
+   * texture, possibly reallocating it, so the frames in flight are waited
+   * for first.
+   */
+  void draw(const sf::Text &t) override {
+    if (!snapshot)
+      return;
+    const auto cs = t.getCharacterSize();
+    bool added{false};
+    for (char32_t c : t.getString())
+      added |= glyphs.insert({&t.getFont(), cs, c}).second;
+    if (added)
+      finish();
+
+    const auto first = snapshot->vertices.size();
+    AppendTextVertices(t, &snapshot->vertices);
+    push(Vertices{first, snapshot->vertices.size() - first,
+                  sf::PrimitiveType::Triangles},
+         sf::RenderStates{&t.getFont().getTexture(cs)});
+  }
+
+  void draw(const sf::RectangleShape &r) override {
+    push(r, sf::RenderStates::Default);
+  }
+
+  void draw(const sf::Sprite &s) override {
+    push(s, sf::RenderStates::Default);
+  }
+
+  void draw(const sf::VertexArray &v, const sf::Texture *t) override {
+    if (!snapshot)
+      return;
+    const auto n = v.getVertexCount();
+    push(Vertices{snapshot->vertices.size(), n, v.getPrimitiveType()},
+         sf::RenderStates{t});
+    if (n)
+      snapshot->vertices.insert(snapshot->vertices.end(), &v[0], &v[0] + n);
+  }
+
+  void present(std::optional<InputClock::time_point> press) override {
+    if (!snapshot || !thread)
+      return;
+    snapshot->press = press;
+    snapshot = nullptr;
+    PublishSnapshot(thread.get());
+  }
+
+  int takeLatency(std::chrono::microseconds *dst) override {
+    return TakeDisplayLatency(thread.get(), dst);
+  }
+
+  void finish() override {
+    if (thread)
+      WaitForRenderThread(thread.get());
+  }
+
+  template <typename T> void push(const T &d, const sf::RenderStates &s) {
+    if (snapshot)
+      snapshot->items.push_back({d, s});
+  }
+
+  /* Declared after the window of the base, so that it is stopped first */
+  std::unique_ptr<RenderThread, int (*)(RenderThread *)> thread{
+      nullptr, DestroyRenderThread};
+  Snapshot *snapshot{nullptr};
+
+  /* The glyphs laid out so far, per font and character size */
+  std::set<std::tuple<const sf::Font *, unsigned, char32_t>> glyphs;
+};
+
+struct RecordingBackend : public RenderBackend {
+  ~RecordingBackend() override {
+    if (!frames)
+      return;
+    const double n = static_cast<double>(frames);
+    std::cout << "frames: " << frames << ", per frame: " << draws / n
+              << " draw calls, " << vertices / n << " vertices, "
+              << area / n / (static_cast<double>(size.x) * size.y)
+              << " overdraw" << std::endl;
+  }
+
+  bool isOpen() const override { return open; }
+  void close() override { open = false; }
+  sf::Vector2u getSize() const override { return size; }
+  std::optional<sf::Event> pollEvent() override { return std::nullopt; }
+  std::optional<sf::Event> waitEvent(std::chrono::milliseconds t) override {
+    std::this_thread::sleep_for(t);
+    return std::nullopt;
+  }
+
+  void begin() override {}
+
+  /* Like sf::Text, one quad per glyph which is not blank */
+  void draw(const sf::Text &t) override {
+    std::size_t glyphs{0};
+    for (char32_t c : t.getString())
+      glyphs += c != U' ' && c != U'\t' && c != U'\n';
+    record(sf::PrimitiveType::Triangles, glyphs * 6,
+           &t.getFont().getTexture(t.getCharacterSize()), t.getGlobalBounds());
+  }
+
+  /* Like sf::Shape, a fan for the fill and a strip for the outline */
+  void draw(const sf::RectangleShape &r) override {
+    const auto points = r.getPointCount();
+    record(sf::PrimitiveType::TriangleFan, points + 2, r.getTexture(),
+           r.getGlobalBounds());
+    if (r.getOutlineThickness() != 0.f)
+      record(sf::PrimitiveType::TriangleStrip, (points + 1) * 2, nullptr,
+             r.getGlobalBounds());
+  }
+
+  void draw(const sf::Sprite &s) override {
+    record(sf::PrimitiveType::TriangleStrip, 4, &s.getTexture(),
+           s.getGlobalBounds());
+  }
+
+  void draw(const sf::VertexArray &v, const sf::Texture *t) override {
+    record(v.getPrimitiveType(), v.getVertexCount(), t, v.getBounds());
+  }
+
+  void present(std::optional<InputClock::time_point> press) override {
+    ++frames;
+    if (press)
+      latency = std::chrono::duration_cast<std::chrono::microseconds>(
+          InputClock::now() - *press);
+  }
+
+  int takeLatency(std::chrono::microseconds *dst) override {
+    if (!dst)
+      return Result::DomainError;
+    if (!latency)
+      return Result::NotFound;
+    *dst = *std::exchange(latency, std::nullopt);
+    return Result::Success;
+  }
+
+  /* The overdraw counts the area covered within the window only */
+  void record(sf::PrimitiveType p, std::size_t n, const sf::Texture *t,
+              const sf::FloatRect &b) {
+    ++draws;
+    vertices += n;
+    if (auto c = b.findIntersection(
+            sf::FloatRect{{}, {static_cast<float>(size.x),
+                               static_cast<float>(size.y)}}))
+      area += static_cast<double>(c->size.x) * c->size.y;
+
+    if (!log.is_open())
+      return;
+
+    /* The textures are numbered in the order they are first drawn with,
+     * zero standing for none
+     */
+    const auto id =
+        t ? textures.try_emplace(t, textures.size() + 1).first->second : 0;
+    static constexpr std::array names{"points",    "lines",
+                                      "linestrip", "triangles",
+                                      "trianglestrip", "trianglefan"};
+    log << frames << ',' << names[static_cast<std::size_t>(p)] << ',' << n
+        << ',' << id << ',' << b.position.x << ',' << b.position.y << ','
+        << b.size.x << ',' << b.size.y << '\n';
+  }
+
+  sf::Vector2u size;
+  std::ofstream log;
+  bool open{true};
+
+  std::unordered_map<const sf::Texture *, std::size_t> textures;
+  std::uint64_t frames{0}, draws{0}, vertices{0};
+  double area{0};
+  std::optional<std::chrono::microseconds> latency;
+};
+} // namespace
+
+int CreateWindowBackend(RenderBackend *&b, sf::VideoMode m,
+                        bool renderThread) {
+  if (!renderThread) {
+    b = new WindowBackend{m};
+    return Result::Success;
+  }
+
+  auto t = std::make_unique<ThreadedBackend>(m);
+  RenderThread *r{nullptr};
+  if (CreateRenderThread(r, &t->window) != Result::Success) {
+    std::cerr << "(ERR): Failed to start the render thread, drawing on the "
+                 "main thread"
+              << std::endl;
+    t.reset();
+    b = new WindowBackend{m};
+    return Result::Success;
+  }
+  t->thread.reset(r);
+  b = t.release();
+  return Result::Success;
+}
+
+int CreateRecordingBackend(RenderBackend *&b, sf::Vector2u size,
+                           const std::string &path) {
+  if (!size.x || !size.y)
+    return Result::DomainError;
+
+  auto r = std::make_unique<RecordingBackend>();
+  r->size = size;
+  if (!path.empty()) {
+    r->log.open(path);
+    if (!r->log) {
+      std::cerr << "(ERR): Failed to open: '" << path << "'" << std::endl;
+      return Result::ReadError;
+    }
+    r->log << "frame,primitive,vertices,texture,left,top,width,height\n";
+  }
+  b = r.release();
+  return Result::Success;
+}
+
+int DestroyRenderBackend(RenderBackend *b) {
+  delete b;
+  return Result::Success;
+}
+} // namespace fb
@@ -0,0 +1,88 @@
+#include <application.hpp>
+#include <batch.hpp>
+#include <cmath>
+#include <result.hpp>
+
+namespace fb {
+struct SpriteBatch {
+  Application *app;
+  sf::VertexArray vertices{sf::PrimitiveType::Triangles};
+  const sf::Texture *texture{nullptr};
+};
+
+namespace {
+/* Each quad is made of two triangles, the corners being given in the
+ * order: top left, top right, bottom left, bottom right.
+ */
+void AppendQuad(SpriteBatch *b, const sf::Transform &t, sf::Vector2f size,
+                sf::FloatRect uv, sf::Color color) {
+  const sf::Vector2f pos[4] = {
+      t.transformPoint({0.f, 0.f}), t.transformPoint({size.x, 0.f}),
+      t.transformPoint({0.f, size.y}), t.transformPoint({size.x, size.y})};
+  const sf::Vector2f tex[4] = {
+      uv.position,
+      {uv.position.x + uv.size.x, uv.position.y},
+      {uv.position.x, uv.position.y + uv.size.y},
+      uv.position + uv.size};
+
+  for (int i : {0, 1, 2, 1, 3, 2})
+    b->vertices.append({pos[i], color, tex[i]});
+}
+
+void SetTexture(SpriteBatch *b, const sf::Texture *t) {
+  if (b->texture != t)
+    FlushSpriteBatch(b);
+  b->texture = t;
+}
+} // namespace
+
+int CreateSpriteBatch(SpriteBatch *&b, Application *a) {
+  if (!a)
+    return Result::DomainError;
+  b = new SpriteBatch{};
+  b->app = a;
+  return Result::Success;
+}
+
+int DestroySpriteBatch(SpriteBatch *b) {
+  delete b;
+  return Result::Success;
+}
+
+void Draw(SpriteBatch *b, const sf::Sprite &s) {
+  if (!b)
+    return;
+
+  SetTexture(b, &s.getTexture());
+  const sf::IntRect r = s.getTextureRect();
+  const sf::Vector2f size{std::abs(static_cast<float>(r.size.x)),
+                          std::abs(static_cast<float>(r.size.y))};
+  AppendQuad(b, s.getTransform(), size, sf::FloatRect{r}, s.getColor());
+}
+
+void Draw(SpriteBatch *b, const sf::RectangleShape &s) {
+  if (!b)
+    return;
+
+  SetTexture(b, nullptr);
+  AppendQuad(b, s.getTransform(), s.getSize(), {}, s.getFillColor());
+}
+
+void Draw(SpriteBatch *b, const sf::FloatRect &r, sf::Color c) {
+  if (!b)
+    return;
+
+  SetTexture(b, nullptr);
+  sf::Transform t;
+  t.translate(r.position);
+  AppendQuad(b, t, r.size, {}, c);
+}
+
+void FlushSpriteBatch(SpriteBatch *b) {
+  if (!b || !b->vertices.getVertexCount())
+    return;
+
+  Render(b->app, b->vertices, b->texture);
+  b->vertices.clear();
+}
+} // namespace fb
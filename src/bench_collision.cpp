@@ -0,0 +1,72 @@
+#include <chrono>
+#include <cmath>
+#include <collision.hpp>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random.hpp>
+#include <result.hpp>
+#include <vector>
+
+/* Measures the cost of a query against grids of growing size. The
+ * colliders are spread over an area growing with their number, like the
+ * obstacles of a longer level, so that a query meets about as many of
+ * them whatever the size. Used as:
+ * bench_collision
+ */
+namespace {
+constexpr std::size_t queries{1'000'000};
+
+/* Somewhere within a square of the given side */
+fb::sim::Rect RandomRect(fb::Pcg32 *g, float side, float w, float h) {
+  const auto bound = static_cast<std::uint32_t>(side);
+  const auto x = static_cast<float>(fb::NextBelow(g, bound));
+  const auto y = static_cast<float>(fb::NextBelow(g, bound));
+  return {x, y, w, h};
+}
+} // namespace
+
+int main() {
+  fb::Pcg32 g;
+  fb::Seed(&g, 42, 0);
+
+  std::cout << std::setw(10) << "colliders" << std::setw(12) << "ns/query"
+            << std::setw(12) << "hits/query" << '\n';
+  for (std::size_t n : {100, 10'000, 100'000}) {
+    /* About one collider per cell */
+    fb::sim::Grid grid;
+    const float side = grid.cellSize * std::sqrt(static_cast<float>(n));
+
+    std::vector<fb::sim::Rect> rects(n);
+    for (auto &&r : rects)
+      r = RandomRect(&g, side, 80.f, 200.f);
+    if (auto r = fb::sim::Build(&grid, rects.data(), rects.size());
+        r != fb::Result::Success) {
+      std::cerr << "(ERR): Failed to build the grid with error code: " << r
+                << std::endl;
+      return r;
+    }
+
+    /* Drawn up front, so that only the queries are timed */
+    std::vector<fb::sim::Rect> probes(queries);
+    for (auto &&p : probes)
+      p = RandomRect(&g, side, 80.f, 60.f);
+
+    std::vector<std::uint32_t> hits;
+    std::uint64_t found{0};
+    const auto start = std::chrono::steady_clock::now();
+    for (auto &&p : probes) {
+      hits.clear();
+      fb::sim::Query(&grid, p, &hits);
+      found += hits.size();
+    }
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::cout << std::setw(10) << n << std::setw(12) << std::fixed
+              << std::setprecision(1) << elapsed.count() / queries
+              << std::setw(12) << std::setprecision(2)
+              << static_cast<double>(found) / queries << '\n';
+  }
+  return fb::Result::Success;
+}
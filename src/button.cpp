@@ -1,9 +1,13 @@
 #include <application.hpp>
 #include <button.hpp>
+#include <collision.hpp>
+#include <input.hpp>
+#include <result.hpp>
+#include <vector>
 
 namespace fb {
 void Button::centerText() {
-  auto tx = this->text.get();
+  auto tx = this->text ? &*this->text : nullptr;
   if (!tx)
     return;
 
@@ -17,36 +21,112 @@ void Button::centerText() {
                        tx->getLocalBounds().position.y});
 }
 
-void Button::update(Application *a) {
-  const sf::Vector2f pos{GetMousePositionX(a), GetMousePositionY(a)};
-  const sf::FloatRect bb{box.getGlobalBounds()};
+struct ButtonLayer {
+  std::vector<Button *> buttons;
+  std::vector<sf::FloatRect> bounds;
 
-  if (bb.contains(pos)) {
-    if (!IsButtonHovered(a)) {
-      SetButtonHovered(a, true);
-      hover_ = true;
-      if (this->onHover)
-        this->onHover(a, this);
-    }
-  } else if (hover_) {
-    SetButtonHovered(a, false);
-    hover_ = false;
-    if (this->onUnHover)
-      this->onUnHover(a, this);
+  /* Indexed like the buttons */
+  sim::Grid grid;
+  std::vector<sim::Rect> rects;
+  std::vector<std::uint32_t> hits;
+
+  Button *hovered{nullptr}, *clicked{nullptr};
+
+  /* Set when the bounds have to be cached again. The pointer is then
+   * looked up even if it did not move, since what lies beneath it may
+   * have changed.
+   */
+  bool stale{true};
+};
+
+namespace {
+void CacheBounds(ButtonLayer *l) {
+  l->bounds.clear();
+  l->rects.clear();
+  for (auto b : l->buttons) {
+    const auto bb = b->box.getGlobalBounds();
+    l->bounds.push_back(bb);
+    l->rects.push_back({bb.position.x, bb.position.y, bb.size.x, bb.size.y});
   }
+  sim::Build(&l->grid, l->rects.data(), l->rects.size());
+  l->stale = false;
+}
+
+Button *FindButton(ButtonLayer *l, sf::Vector2f p) {
+  if (sim::Query(&l->grid, {p.x, p.y, 1.f, 1.f}, &l->hits) !=
+      Result::Success)
+    return nullptr;
 
-  if (IsPrimaryMouseButtonPressed(a)) {
-    if (hover_ && !IsButtonClicked(a)) {
-      SetButtonClicked(a, true);
-      click_ = true;
-      if (this->onClick)
-        this->onClick(a, this);
+  Button *top{nullptr};
+  std::uint32_t topIndex{0};
+  for (auto i : l->hits)
+    if (l->bounds[i].contains(p) && (!top || i > topIndex)) {
+      top = l->buttons[i];
+      topIndex = i;
     }
-  } else if (click_) {
-    SetButtonClicked(a, false);
-    click_ = false;
-    if (this->onUnClick && hover_)
-      this->onUnClick(a, this);
+  return top;
+}
+
+void Notify(const std::function<void(Application *, Button *)> &f,
+            Application *a, Button *b) {
+  if (f)
+    f(a, b);
+}
+} // namespace
+
+int CreateButtonLayer(ButtonLayer *&l) {
+  l = new ButtonLayer{};
+  return Result::Success;
+}
+
+int DestroyButtonLayer(ButtonLayer *l) {
+  delete l;
+  return Result::Success;
+}
+
+void AddButton(ButtonLayer *l, Button *b) {
+  l->buttons.push_back(b);
+  l->stale = true;
+}
+
+void ClearButtons(ButtonLayer *l) {
+  l->buttons.clear();
+  l->hovered = l->clicked = nullptr;
+  l->stale = true;
+}
+
+bool UpdateButtons(ButtonLayer *l, Application *a) {
+  auto in = GetInputQueue(a);
+  const bool pressed = WasPressed(in, Control::Primary);
+  const bool released = WasReleased(in, Control::Primary);
+  if (!l->stale && !pressed && !released && !WasPointerMoved(in))
+    return false;
+  if (l->stale)
+    CacheBounds(l);
+
+  bool changed{false};
+  if (auto b = FindButton(l, GetPointerPosition(in)); b != l->hovered) {
+    changed = true;
+    if (auto old = l->hovered)
+      Notify(old->onUnHover, a, old);
+    l->hovered = b;
+    if (b)
+      Notify(b->onHover, a, b);
+  }
+
+  /* Both may happen within one tick, in which case it is a whole click */
+  if (pressed && l->hovered && !l->clicked) {
+    changed = true;
+    l->clicked = l->hovered;
+    Notify(l->clicked->onClick, a, l->clicked);
+  }
+  if (l->clicked && !IsDown(in, Control::Primary)) {
+    changed = true;
+    auto b = l->clicked;
+    l->clicked = nullptr;
+    if (b == l->hovered)
+      Notify(b->onUnClick, a, b);
   }
+  return changed;
 }
 } // namespace fb
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cmath>
+#include <collision.hpp>
+#include <result.hpp>
+
+namespace {
+struct CellRange {
+  std::int32_t x0, y0, x1, y1;
+};
+
+CellRange GetCellRange(const fb::sim::Grid &g, const fb::sim::Rect &r) {
+  const auto cell = [&g](float v) {
+    return static_cast<std::int32_t>(std::floor(v / g.cellSize));
+  };
+  return {cell(r.x), cell(r.y), cell(r.x + r.w), cell(r.y + r.h)};
+}
+
+std::uint32_t GetBucket(const fb::sim::Grid &g, std::int32_t x,
+                        std::int32_t y) {
+  const auto h = static_cast<std::uint32_t>(x) * 73856093u ^
+                 static_cast<std::uint32_t>(y) * 19349663u;
+  const auto buckets = g.bucketStart.size() - 1;
+  return h & (buckets - 1);
+}
+
+template <typename F> void ForEachBucket(const fb::sim::Grid &g,
+                                         const CellRange &c, F &&f) {
+  for (auto y = c.y0; y <= c.y1; ++y)
+    for (auto x = c.x0; x <= c.x1; ++x)
+      f(GetBucket(g, x, y));
+}
+} // namespace
+
+namespace fb::sim {
+bool Intersects(const Rect &a, const Rect &b) {
+  return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h &&
+         b.y < a.y + a.h;
+}
+
+int Build(Grid *g, const Rect *rects, std::size_t count) {
+  if (!g || (!rects && count) || g->cellSize <= 0)
+    return Result::DomainError;
+
+  g->rects.assign(rects, rects + count);
+  g->stamps.assign(count, g->stamp);
+
+  /* A power of two of at least twice as many buckets as colliders keeps
+   * the buckets short, the extra slot holding the end of the last one
+   */
+  std::size_t buckets = 64;
+  while (buckets < count * 2)
+    buckets *= 2;
+  g->bucketStart.assign(buckets + 1, 0);
+
+  for (auto &&r : g->rects)
+    ForEachBucket(*g, GetCellRange(*g, r),
+                  [g](std::uint32_t b) { ++g->bucketStart[b + 1]; });
+
+  for (std::size_t i = 1; i < g->bucketStart.size(); ++i)
+    g->bucketStart[i] += g->bucketStart[i - 1];
+
+  g->entries.resize(g->bucketStart.back());
+  auto fill = g->bucketStart;
+  for (std::uint32_t i = 0; i < count; ++i)
+    ForEachBucket(*g, GetCellRange(*g, g->rects[i]), [&](std::uint32_t b) {
+      g->entries[fill[b]++] = i;
+    });
+
+  return Result::Success;
+}
+
+int Query(Grid *g, const Rect &r, std::vector<std::uint32_t> *hits) {
+  if (!g || !hits || g->bucketStart.empty())
+    return Result::DomainError;
+
+  hits->clear();
+  if (++g->stamp == 0) {
+    std::fill(g->stamps.begin(), g->stamps.end(), 0);
+    g->stamp = 1;
+  }
+  const auto stamp = g->stamp;
+  ForEachBucket(*g, GetCellRange(*g, r), [&](std::uint32_t b) {
+    for (auto e = g->bucketStart[b]; e < g->bucketStart[b + 1]; ++e) {
+      const auto i = g->entries[e];
+      if (g->stamps[i] == stamp)
+        continue;
+      g->stamps[i] = stamp;
+      if (Intersects(g->rects[i], r))
+        hits->push_back(i);
+    }
+  });
+
+  return Result::Success;
+}
+} // namespace fb::sim
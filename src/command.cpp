@@ -0,0 +1,96 @@
+#include <atomic>
+#include <command.hpp>
+#include <cstdint>
+#include <memory>
+#include <result.hpp>
+#include <trace.hpp>
+
+namespace fb {
+/* Each cell carries a sequence number, which tells the producers whether
+ * the cell is free for the lap they are on, and the consumer whether the
+ * cell has been filled in.
+ */
+struct Cell {
+  std::atomic<std::size_t> sequence;
+  Command command;
+};
+
+struct CommandQueue {
+  std::unique_ptr<Cell[]> cells;
+  std::size_t mask;
+
+  /* Kept on separate cache lines, the tail being shared by the producers */
+  alignas(64) std::atomic<std::size_t> tail{0};
+  alignas(64) std::size_t head{0};
+};
+
+int CreateCommandQueue(CommandQueue *&q, std::size_t capacity) {
+  if (!capacity)
+    return Result::DomainError;
+
+  std::size_t size = 1;
+  while (size < capacity)
+    size *= 2;
+
+  q = new CommandQueue{};
+  q->cells = std::make_unique<Cell[]>(size);
+  q->mask = size - 1;
+  for (std::size_t i = 0; i < size; ++i)
+    q->cells[i].sequence.store(i, std::memory_order_relaxed);
+  return Result::Success;
+}
+
+int DestroyCommandQueue(CommandQueue *q) {
+  delete q;
+  return Result::Success;
+}
+
+int EnqueueCommand(CommandQueue *q, const Command &c) {
+  if (!q || !c.invoke)
+    return Result::DomainError;
+
+  auto pos = q->tail.load(std::memory_order_relaxed);
+  Cell *cell;
+  for (;;) {
+    cell = &q->cells[pos & q->mask];
+    const auto seq = cell->sequence.load(std::memory_order_acquire);
+    const auto diff =
+        static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+    if (diff == 0) {
+      if (q->tail.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      return Result::Error;
+    } else {
+      pos = q->tail.load(std::memory_order_relaxed);
+    }
+  }
+
+  cell->command = c;
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return Result::Success;
+}
+
+int DrainCommandQueue(CommandQueue *q, Application *a) {
+  if (!q)
+    return Result::DomainError;
+
+  for (;;) {
+    auto &cell = q->cells[q->head & q->mask];
+    if (cell.sequence.load(std::memory_order_acquire) != q->head + 1)
+      break;
+
+    /* The cell is released before the command runs, so that the command
+     * may post further commands
+     */
+    Command c = cell.command;
+    cell.sequence.store(q->head + q->mask + 1, std::memory_order_release);
+    ++q->head;
+    TraceSpan span{"command"};
+    c.invoke(c.data, a);
+  }
+
+  return Result::Success;
+}
+} // namespace fb
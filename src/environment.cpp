@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <environment.hpp>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <result.hpp>
+#include <thread>
+#include <vector>
+
+namespace fb::sim {
+namespace {
+/* A range of environments, stepped by one worker */
+struct Task {
+  std::size_t first, last;
+};
+
+/* The owner takes tasks from the back of its deque, thieves from the
+ * front. The deques are only touched once per task, so a lock each is
+ * cheap next to the steps of a whole chunk.
+ */
+struct alignas(64) Worker {
+  std::mutex mutex;
+  std::deque<Task> tasks;
+};
+} // namespace
+
+struct Environments {
+  Config config;
+  std::vector<World> worlds;
+
+  /* One stream of game seeds per environment */
+  std::vector<Pcg32> seeds;
+  std::vector<std::uint64_t> episodes, scores;
+
+  std::vector<float> observations, rewards;
+  std::vector<std::uint8_t> done;
+
+  /* The arguments of the current run */
+  const Policy *policy{nullptr};
+  std::size_t steps{0};
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::thread> threads;
+
+  std::mutex mutex;
+  std::condition_variable wake, idle;
+  std::uint64_t generation{0};
+  bool stop{false};
+  std::atomic<std::size_t> remaining{0};
+};
+
+namespace {
+void Observe(const World &w, float *o) {
+  const auto &c = w.config;
+  const auto &b = w.bird.body;
+
+  /* The next fence is the leftmost one not yet passed by the bird */
+  const auto &f = w.fences;
+  std::optional<std::size_t> next;
+  for (std::size_t i = 0; i < Count(f); ++i)
+    if (f.x[i] + f.w[i] > b.x && (!next || f.x[i] < f.x[*next]))
+      next = i;
+
+  o[0] = b.y / c.height;
+  o[1] = w.bird.v / c.height;
+  o[2] = next ? (f.x[*next] - b.x) / c.width : 1.f;
+  o[3] = next ? f.y[*next] / c.height : 0.f;
+  o[4] = next ? f.h[*next] / c.height : 0.f;
+  o[5] = Count(w.rockets) ? (w.rockets.x[0] - b.x) / c.width : 1.f;
+  o[6] = Count(w.rockets) ? (w.rockets.y[0] - b.y) / c.height : 0.f;
+  o[7] = w.launched;
+}
+
+void NewGame(Environments *e, std::size_t i) {
+  Config c = e->config;
+  c.seed = Next(&e->seeds[i]);
+  Reset(&e->worlds[i], c);
+}
+
+void Simulate(Environments *e, Task t) {
+  const auto &policy = *e->policy;
+  for (std::size_t i = t.first; i < t.last; ++i) {
+    World &w = e->worlds[i];
+    float *obs = e->observations.data() + i * observationSize;
+    float *rewards = e->rewards.data() + i * e->steps;
+    std::uint8_t *done = e->done.data() + i * e->steps;
+
+    for (std::size_t s = 0; s < e->steps; ++s) {
+      const unsigned score = w.score;
+      Step(&w, policy(i, obs));
+      rewards[s] = static_cast<float>(w.score - score);
+      done[s] = w.gameOver;
+      if (w.gameOver) {
+        rewards[s] -= 1.f;
+        ++e->episodes[i];
+        e->scores[i] += w.score;
+        NewGame(e, i);
+      }
+      Observe(w, obs);
+    }
+  }
+}
+
+std::optional<Task> Take(Environments *e, std::size_t self) {
+  {
+    Worker &w = *e->workers[self];
+    std::lock_guard lock{w.mutex};
+    if (!w.tasks.empty()) {
+      const Task t = w.tasks.back();
+      w.tasks.pop_back();
+      return t;
+    }
+  }
+
+  /* Victims are visited starting next to the thief, so that the thieves
+   * do not all pile onto the same worker
+   */
+  const std::size_t n = e->workers.size();
+  for (std::size_t k = 1; k < n; ++k) {
+    Worker &v = *e->workers[(self + k) % n];
+    std::lock_guard lock{v.mutex};
+    if (!v.tasks.empty()) {
+      const Task t = v.tasks.front();
+      v.tasks.pop_front();
+      return t;
+    }
+  }
+  return std::nullopt;
+}
+
+void Drain(Environments *e, std::size_t self) {
+  while (auto t = Take(e, self)) {
+    Simulate(e, *t);
+    if (e->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      std::lock_guard lock{e->mutex};
+      e->idle.notify_all();
+    }
+  }
+}
+
+void Work(Environments *e, std::size_t self) {
+  std::uint64_t seen{0};
+  while (true) {
+    {
+      std::unique_lock lock{e->mutex};
+      e->wake.wait(lock, [&] { return e->stop || e->generation != seen; });
+      if (e->stop)
+        return;
+      seen = e->generation;
+    }
+    Drain(e, self);
+  }
+}
+} // namespace
+
+int CreateEnvironments(Environments *&e, const Config &c, std::size_t count,
+                       unsigned threads) {
+  if (!count || !threads || c.tick <= 0)
+    return Result::DomainError;
+
+  e = new Environments{};
+  e->config = c;
+  e->worlds.resize(count);
+  e->seeds.resize(count);
+  e->episodes.resize(count);
+  e->scores.resize(count);
+  e->observations.resize(count * observationSize);
+
+  for (std::size_t i = 0; i < count; ++i) {
+    Seed(&e->seeds[i], c.seed, stream::environments + i);
+    NewGame(e, i);
+    Observe(e->worlds[i], e->observations.data() + i * observationSize);
+  }
+
+  const std::size_t n = std::min<std::size_t>(threads, count);
+  for (std::size_t i = 0; i < n; ++i)
+    e->workers.push_back(std::make_unique<Worker>());
+  for (std::size_t i = 1; i < n; ++i)
+    e->threads.emplace_back(Work, e, i);
+  return Result::Success;
+}
+
+int DestroyEnvironments(Environments *e) {
+  if (!e)
+    return Result::DomainError;
+
+  {
+    std::lock_guard lock{e->mutex};
+    e->stop = true;
+  }
+  e->wake.notify_all();
+  for (auto &&t : e->threads)
+    t.join();
+  delete e;
+  return Result::Success;
+}
+
+int Run(Environments *e, const Policy &p, std::size_t steps) {
+  if (!e || !p)
+    return Result::DomainError;
+
+  const std::size_t count = e->worlds.size();
+  e->policy = &p;
+  e->steps = steps;
+  e->rewards.assign(count * steps, 0.f);
+  e->done.assign(count * steps, 0);
+
+  /* A few chunks per worker leave something to steal from the slower ones,
+   * while keeping each chunk long enough to be worth taking
+   */
+  const std::size_t n = e->workers.size();
+  const std::size_t chunk = std::max<std::size_t>(1, count / (n * 4));
+
+  /* Counted before any task is pushed, since a worker still draining the
+   * previous run may take one right away
+   */
+  e->remaining.store((count + chunk - 1) / chunk, std::memory_order_release);
+  for (std::size_t first = 0, i = 0; first < count; first += chunk, ++i) {
+    Worker &w = *e->workers[i % n];
+    std::lock_guard lock{w.mutex};
+    w.tasks.push_back({first, std::min(first + chunk, count)});
+  }
+
+  {
+    std::lock_guard lock{e->mutex};
+    ++e->generation;
+  }
+  e->wake.notify_all();
+
+  Drain(e, 0);
+
+  std::unique_lock lock{e->mutex};
+  e->idle.wait(lock, [e] {
+    return e->remaining.load(std::memory_order_acquire) == 0;
+  });
+  return Result::Success;
+}
+
+std::size_t Count(const Environments *e) { return e->worlds.size(); }
+
+const float *GetObservations(const Environments *e) {
+  return e->observations.data();
+}
+
+const float *GetRewards(const Environments *e) { return e->rewards.data(); }
+
+const std::uint8_t *GetDone(const Environments *e) { return e->done.data(); }
+
+std::uint64_t GetEpisodeCount(const Environments *e) {
+  return std::accumulate(e->episodes.begin(), e->episodes.end(),
+                         std::uint64_t{0});
+}
+
+std::uint64_t GetTotalScore(const Environments *e) {
+  return std::accumulate(e->scores.begin(), e->scores.end(),
+                         std::uint64_t{0});
+}
+} // namespace fb::sim
@@ -0,0 +1,273 @@
+#include <archive.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <imagecache.hpp>
+#include <iomanip>
+#include <iostream>
+#include <result.hpp>
+#include <sstream>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <trace.hpp>
+
+#if defined(_WIN32)
+#include <process.h>
+#include <vector>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace fb {
+struct ImageCache {
+  fs::path dir;
+};
+
+namespace {
+/* A read only view of a whole entry */
+struct Mapping {
+  const std::byte *data{nullptr};
+  std::size_t size{0};
+#if defined(_WIN32)
+  std::vector<std::byte> buffer;
+#endif
+
+  Mapping() = default;
+  Mapping(const Mapping &) = delete;
+  Mapping &operator=(const Mapping &) = delete;
+  ~Mapping() {
+#if !defined(_WIN32)
+    if (data)
+      ::munmap(const_cast<std::byte *>(data), size);
+#endif
+  }
+};
+
+int Map(Mapping *m, const fs::path &path) {
+#if defined(_WIN32)
+  std::ifstream in{path, std::ios::binary | std::ios::ate};
+  if (!in)
+    return Result::NotFound;
+  m->buffer.resize(static_cast<std::size_t>(in.tellg()));
+  in.seekg(0);
+  if (!in.read(reinterpret_cast<char *>(m->buffer.data()), m->buffer.size()))
+    return Result::ReadError;
+  m->data = m->buffer.data();
+  m->size = m->buffer.size();
+#else
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return Result::NotFound;
+
+  struct stat st{};
+  if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    return Result::ReadError;
+  }
+
+  void *p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED)
+    return Result::ReadError;
+
+  m->data = static_cast<const std::byte *>(p);
+  m->size = st.st_size;
+#endif
+  return Result::Success;
+}
+
+/* Named after a hash of the source. Sources whose hashes collide are
+ * told apart by the source stored in the entry.
+ */
+fs::path GetEntryPath(ImageCache *c, const ImageKey &k) {
+  std::ostringstream name;
+  name << std::hex << std::setw(16) << std::setfill('0')
+       << std::hash<std::string>{}(k.source) << ".rgba";
+  return c->dir / name.str();
+}
+
+int GetProcessId() {
+#if defined(_WIN32)
+  return ::_getpid();
+#else
+  return ::getpid();
+#endif
+}
+
+std::int64_t GetModificationTime(const fs::path &path) {
+  std::error_code ec;
+  const auto t = fs::last_write_time(path, ec);
+  return ec ? 0 : t.time_since_epoch().count();
+}
+
+/* Maps the entry of the key and returns its pixels, or nullptr unless the
+ * entry is complete and was decoded from the very same source
+ */
+const std::uint8_t *MapEntry(ImageCache *c, const ImageKey &k, Mapping *m,
+                             sf::Vector2u *size) {
+  if (Map(m, GetEntryPath(c, k)) != Result::Success ||
+      m->size < sizeof(rgba::Header))
+    return nullptr;
+
+  rgba::Header h;
+  std::memcpy(&h, m->data, sizeof(h));
+  if (std::memcmp(h.magic, rgba::magic, sizeof(h.magic)) ||
+      h.version != rgba::version || h.mtime != k.mtime || h.size != k.size ||
+      h.sourceLength != k.source.size())
+    return nullptr;
+
+  const std::size_t pixels = sizeof(h) + h.sourceLength;
+  if (m->size != pixels + std::size_t{h.width} * h.height * 4 ||
+      std::string_view{reinterpret_cast<const char *>(m->data + sizeof(h)),
+                       h.sourceLength} != k.source)
+    return nullptr;
+
+  *size = {h.width, h.height};
+  return reinterpret_cast<const std::uint8_t *>(m->data + pixels);
+}
+} // namespace
+
+int GetImageKey(const std::string &path, ImageKey *dst) {
+  if (!dst)
+    return Result::DomainError;
+
+  std::error_code ec;
+  const auto size = fs::file_size(path, ec);
+  if (ec)
+    return Result::NotFound;
+
+  auto canonical = fs::weakly_canonical(path, ec);
+  dst->source = ec ? path : canonical.string();
+  dst->mtime = GetModificationTime(path);
+  dst->size = size;
+  return Result::Success;
+}
+
+int GetImageKey(Archive *ar, const std::string &name, ImageKey *dst) {
+  const void *data{nullptr};
+  std::size_t size{0};
+  if (!dst)
+    return Result::DomainError;
+  if (auto r = FindArchiveEntry(ar, name, &data, &size); r != Result::Success)
+    return r;
+
+  dst->source = "pak:" + name;
+  dst->mtime = GetArchiveModificationTime(ar);
+  dst->size = size;
+  return Result::Success;
+}
+
+int CreateImageCache(ImageCache *&c, const std::string &dir) {
+  if (dir.empty())
+    return Result::DomainError;
+
+  std::error_code ec;
+  fs::create_directories(dir, ec);
+  if (ec) {
+    std::cerr << "(ERR): Failed to create the image cache: '" << dir << "'"
+              << std::endl;
+    return Result::Error;
+  }
+
+  c = new ImageCache{dir};
+  return Result::Success;
+}
+
+int DestroyImageCache(ImageCache *c) {
+  delete c;
+  return Result::Success;
+}
+
+int ReadCachedImage(ImageCache *c, const ImageKey &k, sf::Image *dst) {
+  if (!c || !dst)
+    return Result::DomainError;
+
+  TraceSpan span{"read cached image", k.source};
+  Mapping m;
+  sf::Vector2u size;
+  const auto pixels = MapEntry(c, k, &m, &size);
+  if (!pixels)
+    return Result::NotFound;
+
+  dst->resize(size, pixels);
+  return Result::Success;
+}
+
+int ReadCachedTexture(ImageCache *c, const ImageKey &k, sf::Texture *dst) {
+  if (!c || !dst)
+    return Result::DomainError;
+
+  TraceSpan span{"read cached image", k.source};
+  Mapping m;
+  sf::Vector2u size;
+  const auto pixels = MapEntry(c, k, &m, &size);
+  if (!pixels)
+    return Result::NotFound;
+
+  /* Uploaded straight out of the mapping */
+  if (!dst->resize(size))
+    return Result::Error;
+  dst->update(pixels);
+  return Result::Success;
+}
+
+int WriteCachedImage(ImageCache *c, const ImageKey &k, const sf::Image &img) {
+  if (!c)
+    return Result::DomainError;
+
+  TraceSpan span{"write cached image", k.source};
+  const auto size = img.getSize();
+  rgba::Header h{};
+  std::memcpy(h.magic, rgba::magic, sizeof(h.magic));
+  h.version = rgba::version;
+  h.width = size.x;
+  h.height = size.y;
+  h.mtime = k.mtime;
+  h.size = k.size;
+  h.sourceLength = static_cast<std::uint32_t>(k.source.size());
+
+  /* Written next to the entry and renamed over it, so that neither a
+   * reader nor a concurrent writer of the same entry, in this process or
+   * another one sharing the directory, sees it half done
+   */
+  const auto path = GetEntryPath(c, k);
+  std::ostringstream suffix;
+  suffix << ".tmp" << GetProcessId() << '.' << std::this_thread::get_id();
+  auto tmp = path;
+  tmp += suffix.str();
+
+  {
+    std::ofstream out{tmp, std::ios::binary | std::ios::trunc};
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    out.write(k.source.data(), k.source.size());
+    if (size.x && size.y)
+      out.write(reinterpret_cast<const char *>(img.getPixelsPtr()),
+                std::streamsize{size.x} * size.y * 4);
+    out.close();
+    if (!out) {
+      std::cerr << "(ERR): Failed to write the cached image: '"
+                << tmp.string() << "'" << std::endl;
+      std::error_code ec;
+      fs::remove(tmp, ec);
+      return Result::Error;
+    }
+  }
+
+  std::error_code ec;
+  fs::rename(tmp, path, ec);
+  if (ec) {
+    std::cerr << "(ERR): Failed to write the cached image: '"
+              << path.string() << "'" << std::endl;
+    fs::remove(tmp, ec);
+    return Result::Error;
+  }
+  return Result::Success;
+}
+} // namespace fb
@@ -0,0 +1,136 @@
+#include <cstdint>
+#include <input.hpp>
+#include <optional>
+#include <result.hpp>
+#include <utility>
+#include <vector>
+
+namespace fb {
+struct InputQueue {
+  struct Edge {
+    Control control;
+    bool down;
+    InputClock::time_point stamp;
+  };
+
+  /* Cleared every tick, keeping its capacity */
+  std::vector<Edge> queued;
+
+  std::uint32_t down{0}, pressed{0}, released{0};
+  sf::Vector2f pointer;
+  bool moved{false}, movedSinceTick{false};
+  std::optional<InputClock::time_point> oldestPress;
+};
+
+namespace {
+std::uint32_t GetBit(Control c) { return 1u << static_cast<unsigned>(c); }
+
+void Queue(InputQueue *q, Control c, bool down, InputClock::time_point t) {
+  q->queued.push_back({c, down, t});
+}
+} // namespace
+
+int CreateInputQueue(InputQueue *&q) {
+  q = new InputQueue{};
+  q->queued.reserve(64);
+  return Result::Success;
+}
+
+int DestroyInputQueue(InputQueue *q) {
+  delete q;
+  return Result::Success;
+}
+
+void FeedEvent(InputQueue *q, const sf::Event &e, InputClock::time_point t) {
+  if (!q)
+    return;
+
+  if (auto k = e.getIf<sf::Event::KeyPressed>())
+    if (k->code == sf::Keyboard::Key::Space)
+      Queue(q, Control::Flap, true, t);
+
+  if (auto k = e.getIf<sf::Event::KeyReleased>())
+    if (k->code == sf::Keyboard::Key::Space)
+      Queue(q, Control::Flap, false, t);
+
+  if (auto m = e.getIf<sf::Event::MouseButtonPressed>())
+    if (m->button == sf::Mouse::Button::Left) {
+      q->pointer = sf::Vector2f{m->position};
+      q->movedSinceTick = true;
+      Queue(q, Control::Primary, true, t);
+    }
+
+  if (auto m = e.getIf<sf::Event::MouseButtonReleased>())
+    if (m->button == sf::Mouse::Button::Left) {
+      q->pointer = sf::Vector2f{m->position};
+      q->movedSinceTick = true;
+      Queue(q, Control::Primary, false, t);
+    }
+
+  if (auto m = e.getIf<sf::Event::MouseMoved>()) {
+    q->pointer = sf::Vector2f{m->position};
+    q->movedSinceTick = true;
+  }
+
+  /* The release of a control held while the window loses the focus is
+   * never reported, so everything is released right away
+   */
+  if (e.is<sf::Event::FocusLost>())
+    for (int c = 0; c < static_cast<int>(Control::Count); ++c)
+      Queue(q, static_cast<Control>(c), false, t);
+}
+
+void BeginTick(InputQueue *q) {
+  if (!q)
+    return;
+
+  q->pressed = q->released = 0;
+  q->moved = std::exchange(q->movedSinceTick, false);
+  for (auto &&e : q->queued) {
+    const auto bit = GetBit(e.control);
+    if (e.down && !(q->down & bit)) {
+      q->down |= bit;
+      q->pressed |= bit;
+      if (!q->oldestPress || e.stamp < *q->oldestPress)
+        q->oldestPress = e.stamp;
+    } else if (!e.down && (q->down & bit)) {
+      q->down &= ~bit;
+      q->released |= bit;
+    }
+  }
+  q->queued.clear();
+}
+
+bool IsDown(InputQueue *q, Control c) { return q && (q->down & GetBit(c)); }
+
+bool WasPressed(InputQueue *q, Control c) {
+  return q && (q->pressed & GetBit(c));
+}
+
+bool WasReleased(InputQueue *q, Control c) {
+  return q && (q->released & GetBit(c));
+}
+
+sf::Vector2f GetPointerPosition(InputQueue *q) {
+  return q ? q->pointer : sf::Vector2f{};
+}
+
+bool WasPointerMoved(InputQueue *q) { return q && q->moved; }
+
+bool HasPendingInput(InputQueue *q) {
+  return q && (!q->queued.empty() || q->movedSinceTick);
+}
+
+int TakeInputLatency(InputQueue *q, InputClock::time_point displayed,
+                     std::chrono::microseconds *dst) {
+  if (!q || !dst)
+    return Result::DomainError;
+  if (!q->oldestPress)
+    return Result::NotFound;
+
+  *dst = std::chrono::duration_cast<std::chrono::microseconds>(
+      displayed - *q->oldestPress);
+  q->oldestPress.reset();
+  return Result::Success;
+}
+} // namespace fb
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <application.hpp>
+#include <label.hpp>
+#include <result.hpp>
+
+namespace fb {
+namespace {
+/* Mirrors the way sf::Text lays out a glyph on a line whose baseline is
+ * one character size below the top, including the padding around it
+ */
+std::array<sf::Vertex, 6> BakeGlyph(const sf::Glyph &g, float baseline,
+                                    sf::Color color) {
+  constexpr float padding{1.f};
+  const float left = g.bounds.position.x - padding;
+  const float top = baseline + g.bounds.position.y - padding;
+  const float right = g.bounds.position.x + g.bounds.size.x + padding;
+  const float bottom =
+      baseline + g.bounds.position.y + g.bounds.size.y + padding;
+
+  const sf::IntRect &r = g.textureRect;
+  const float u0 = r.position.x - padding, v0 = r.position.y - padding;
+  const float u1 = r.position.x + r.size.x + padding;
+  const float v1 = r.position.y + r.size.y + padding;
+
+  return {sf::Vertex{{left, top}, color, {u0, v0}},
+          sf::Vertex{{right, top}, color, {u1, v0}},
+          sf::Vertex{{left, bottom}, color, {u0, v1}},
+          sf::Vertex{{left, bottom}, color, {u0, v1}},
+          sf::Vertex{{right, top}, color, {u1, v0}},
+          sf::Vertex{{right, bottom}, color, {u1, v1}}};
+}
+} // namespace
+
+void AppendTextVertices(const sf::Text &t, std::vector<sf::Vertex> *dst) {
+  const sf::Font &f = t.getFont();
+  const unsigned cs = t.getCharacterSize();
+  const float whitespace = f.getGlyph(U' ', cs, false).advance;
+  const float lineSpacing = f.getLineSpacing(cs);
+  const sf::Transform &transform = t.getTransform();
+
+  float x{0}, y{static_cast<float>(cs)};
+  char32_t prev{0};
+  for (char32_t c : t.getString()) {
+    if (c == U'\r')
+      continue;
+    x += f.getKerning(prev, c, cs, false);
+    prev = c;
+
+    if (c == U'\n') {
+      y += lineSpacing;
+      x = 0;
+      continue;
+    }
+    if (c == U' ' || c == U'\t') {
+      x += c == U' ' ? whitespace : whitespace * 4;
+      continue;
+    }
+
+    const auto &g = f.getGlyph(c, cs, false);
+    for (auto v : BakeGlyph(g, y, t.getFillColor())) {
+      v.position = transform.transformPoint(v.position + sf::Vector2f{x, 0});
+      dst->push_back(v);
+    }
+    x += g.advance;
+  }
+}
+
+int NumberLabel::build(const sf::Font &f, unsigned cs, sf::Color c,
+                       const std::string &prefix) {
+  font_ = &f;
+  characterSize_ = cs;
+
+  prefix_ = std::make_unique<sf::Text>(f, prefix, cs);
+  prefix_->setFillColor(c);
+  prefixWidth_ = prefix_->findCharacterPos(prefix.size()).x;
+  const auto bounds = prefix_->getLocalBounds();
+  centreY_ = bounds.position.y + bounds.size.y / 2.f;
+
+  pitch_ = 0;
+  for (std::size_t d = 0; d < glyphs_.size(); ++d) {
+    const auto &g = f.getGlyph(U'0' + d, cs, false);
+    glyphs_[d] = BakeGlyph(g, static_cast<float>(cs), c);
+    pitch_ = std::max(pitch_, g.advance);
+  }
+
+  /* Reserved up front, so that a longer number does not allocate */
+  vertices_.resize(maxDigits * 6);
+  count_ = 0;
+  value_ = 0;
+  set(0);
+  return Result::Success;
+}
+
+void NumberLabel::set(unsigned value) {
+  if (value == value_ && count_)
+    return;
+  value_ = value;
+
+  std::array<std::uint8_t, maxDigits> digits{};
+  std::size_t n = 0;
+  do {
+    digits[n++] = value % 10;
+    value /= 10;
+  } while (value);
+
+  /* A different number of digits moves the centre, so every vertex is
+   * laid out again. Otherwise only the digits which differ are rewritten.
+   */
+  const bool moved = n != count_;
+  count_ = n;
+  vertices_.resize(n * 6);
+  if (moved && prefix_)
+    prefix_->setPosition(getOrigin());
+
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto d = digits[n - 1 - i];
+    if (!moved && digits_[i] == d)
+      continue;
+
+    digits_[i] = d;
+    place(i);
+  }
+}
+
+void NumberLabel::setPosition(sf::Vector2f p) {
+  anchor_ = p;
+  if (!prefix_)
+    return;
+
+  prefix_->setPosition(getOrigin());
+  for (std::size_t i = 0; i < count_; ++i)
+    place(i);
+}
+
+sf::Vector2f NumberLabel::getOrigin() const {
+  return anchor_ - sf::Vector2f{(prefixWidth_ + count_ * pitch_) / 2.f,
+                                centreY_};
+}
+
+void NumberLabel::place(std::size_t i) {
+  const auto o = getOrigin() + sf::Vector2f{prefixWidth_ + i * pitch_, 0.f};
+  for (std::size_t v = 0; v < 6; ++v) {
+    vertices_[i * 6 + v] = glyphs_[digits_[i]][v];
+    vertices_[i * 6 + v].position += o;
+  }
+}
+
+void Render(Application *a, const NumberLabel *l) {
+  if (!l->prefix_)
+    return;
+
+  Render(a, l->prefix_.get());
+  Render(a, l->vertices_, &l->font_->getTexture(l->characterSize_));
+}
+} // namespace fb
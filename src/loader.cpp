@@ -0,0 +1,182 @@
+#include <archive.hpp>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <imagecache.hpp>
+#include <iostream>
+#include <loader.hpp>
+#include <mutex>
+#include <result.hpp>
+#include <thread>
+#include <trace.hpp>
+#include <vector>
+
+namespace {
+/* Jobs for entries of an archive decode straight from its memory. With
+ * an image cache, a job reads the decoded image from there if it can.
+ */
+struct Job {
+  std::string path;
+  fb::TextureCallback callback;
+  const void *data{nullptr};
+  std::size_t size{0};
+  fb::ImageCache *images{nullptr};
+  fb::ImageKey key;
+};
+
+struct Decoded {
+  std::string path;
+  fb::TextureCallback callback;
+  sf::Image image;
+  bool ok;
+};
+} // namespace
+
+namespace fb {
+struct AssetLoader {
+  ResourceCache *cache;
+  std::vector<std::thread> workers;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<Job> jobs;
+  std::deque<Decoded> decoded;
+  bool stop{false};
+
+  /* Only touched by the thread which owns the loader */
+  std::size_t done{0}, total{0};
+};
+
+namespace {
+void Work(AssetLoader *l) {
+  SetTraceThreadName("loader");
+  while (true) {
+    Job job;
+    {
+      std::unique_lock lock{l->mutex};
+      l->cv.wait(lock, [l] { return l->stop || !l->jobs.empty(); });
+      if (l->stop)
+        return;
+      job = std::move(l->jobs.front());
+      l->jobs.pop_front();
+    }
+
+    Decoded d{std::move(job.path), std::move(job.callback), {}, false};
+    if (job.images &&
+        ReadCachedImage(job.images, job.key, &d.image) == Result::Success) {
+      d.ok = true;
+    } else {
+      TraceSpan span{"decode", d.path};
+      d.ok = job.data ? d.image.loadFromMemory(job.data, job.size)
+                      : d.image.loadFromFile(d.path);
+      if (d.ok && job.images)
+        WriteCachedImage(job.images, job.key, d.image);
+    }
+
+    std::lock_guard lock{l->mutex};
+    l->decoded.push_back(std::move(d));
+  }
+}
+} // namespace
+
+int CreateAssetLoader(AssetLoader *&l, ResourceCache *c, unsigned threads) {
+  if (!c || !threads)
+    return Result::DomainError;
+
+  l = new AssetLoader{};
+  l->cache = c;
+  for (unsigned i = 0; i < threads; ++i)
+    l->workers.emplace_back(Work, l);
+  return Result::Success;
+}
+
+int DestroyAssetLoader(AssetLoader *l) {
+  if (!l)
+    return Result::Success;
+
+  {
+    std::lock_guard lock{l->mutex};
+    l->stop = true;
+  }
+  l->cv.notify_all();
+  for (auto &&w : l->workers)
+    w.join();
+
+  delete l;
+  return Result::Success;
+}
+
+int RequestTexture(AssetLoader *l, const std::string &path,
+                   TextureCallback cb) {
+  if (!l || !path.size())
+    return Result::DomainError;
+
+  Job job{path, std::move(cb), nullptr, 0, nullptr, {}};
+  auto ar = GetMountedArchive(l->cache);
+  const auto name = GetArchiveEntryName(path);
+  const bool packed = ar && FindArchiveEntry(ar, name, &job.data,
+                                             &job.size) == Result::Success;
+  if (!packed && !std::filesystem::exists(path)) {
+    std::cerr << "(ERR): The resource path: '" << path << "' is not valid!"
+              << std::endl;
+    return Result::DomainError;
+  }
+
+  /* Keyed here, so that the workers need not touch the archive */
+  if (auto images = GetMountedImageCache(l->cache);
+      images && (packed ? GetImageKey(ar, name, &job.key)
+                        : GetImageKey(path, &job.key)) == Result::Success)
+    job.images = images;
+
+  ++l->total;
+  {
+    std::lock_guard lock{l->mutex};
+    l->jobs.push_back(std::move(job));
+  }
+  l->cv.notify_one();
+  return Result::Success;
+}
+
+int PumpAssetLoader(AssetLoader *l) {
+  if (!l)
+    return Result::DomainError;
+
+  std::deque<Decoded> ready;
+  {
+    std::lock_guard lock{l->mutex};
+    ready.swap(l->decoded);
+  }
+
+  int result = Result::Success;
+  for (auto &&d : ready) {
+    ++l->done;
+
+    TextureHandle t;
+    int r = Result::ReadError;
+    if (d.ok)
+      r = StoreTexture(l->cache, d.path, d.image, &t);
+    else
+      std::cerr << "(ERR): Failed to decode image: '" << d.path << "'"
+                << std::endl;
+
+    if (r != Result::Success)
+      result = r;
+    if (d.callback)
+      d.callback(r, std::move(t));
+  }
+
+  if (l->done == l->total)
+    l->done = l->total = 0;
+
+  return result;
+}
+
+int GetAssetLoaderProgress(AssetLoader *l, std::size_t *done,
+                           std::size_t *total) {
+  if (!l || !done || !total)
+    return Result::DomainError;
+  *done = l->done;
+  *total = l->total;
+  return Result::Success;
+}
+} // namespace fb
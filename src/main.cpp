@@ -1,7 +1,42 @@
 #include <application.hpp>
+#include <iostream>
 #include <result.hpp>
+#include <string_view>
+
+namespace {
+void PrintUsage() {
+  std::cout
+      << "Usage: run [option value]...\n"
+         "  --width, -w, --height, -h   size of the window\n"
+         "  --time-per-frame, -t        milliseconds per frame (16)\n"
+         "  --frame-rate                frames per second, instead\n"
+         "  --tick-rate, -r             ticks of the game per second (60)\n"
+         "  --max-ticks-per-frame       ticks run to catch up per frame (5)\n"
+         "  --seed                      seed of every random number\n"
+         "  --image-cache               directory of the decoded textures,\n"
+         "                              none when empty (./cache)\n"
+         "  --overlay 1                 shows the frame statistics (F3)\n"
+         "  --stats                     CSV file of the frame statistics\n"
+         "  --trace                     JSON file of the trace (F4)\n"
+         "  --record, --replay          file of a recorded game\n"
+         "  --unthrottled 1             runs a tick per frame at full speed\n"
+         "  --render-thread 1           draws the frames on another thread\n"
+         "  --headless 1                counts the draw calls without a\n"
+         "                              window. Textures and fonts still\n"
+         "                              need an OpenGL context, so on Linux\n"
+         "                              a display is required, e.g. Xvfb\n"
+         "  --render-log                CSV file of every draw call, implies\n"
+         "                              --headless 1\n";
+}
+} // namespace
 
 int main(int argc, char **argv) {
+  for (int i = 1; i < argc; ++i)
+    if (std::string_view{argv[i]} == "--help") {
+      PrintUsage();
+      return fb::Result::Success;
+    }
+
   fb::Application *app{nullptr};
 
   if (auto r = fb::Initialize(app, argc, argv); r == fb::Result::Success) {
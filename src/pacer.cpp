@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <pacer.hpp>
+#include <result.hpp>
+#include <thread>
+
+namespace fb {
+struct FramePacer {
+  PacerClock::duration period;
+  PacerClock::time_point deadline, last;
+
+  /* How much later than asked the sleeps return, smoothed */
+  PacerClock::duration overshoot{std::chrono::microseconds{200}};
+};
+
+namespace {
+using namespace std::chrono_literals;
+
+/* The spin margin is twice the usual overshoot, within these bounds */
+constexpr PacerClock::duration minMargin{50us}, maxMargin{2ms};
+} // namespace
+
+int CreateFramePacer(FramePacer *&p, std::chrono::duration<double> period) {
+  if (period.count() < 0)
+    return Result::DomainError;
+
+  p = new FramePacer{};
+  p->period = std::chrono::duration_cast<PacerClock::duration>(period);
+  p->last = PacerClock::now();
+  p->deadline = p->last + p->period;
+  return Result::Success;
+}
+
+int DestroyFramePacer(FramePacer *p) {
+  delete p;
+  return Result::Success;
+}
+
+void WaitForNextFrame(FramePacer *p, std::chrono::microseconds *elapsed,
+                      std::chrono::microseconds *late) {
+  const auto margin = std::clamp(2 * p->overshoot, minMargin, maxMargin);
+  if (const auto wake = p->deadline - margin; PacerClock::now() < wake) {
+    std::this_thread::sleep_until(wake);
+    const auto over = PacerClock::now() - wake;
+    p->overshoot = (7 * p->overshoot + std::max(over, {})) / 8;
+  }
+  while (PacerClock::now() < p->deadline)
+    std::this_thread::yield();
+
+  const auto start = PacerClock::now();
+  *elapsed = std::chrono::duration_cast<std::chrono::microseconds>(start -
+                                                                   p->last);
+  *late = std::chrono::duration_cast<std::chrono::microseconds>(start -
+                                                                p->deadline);
+  p->last = start;
+  p->deadline += p->period;
+  if (p->deadline < start)
+    p->deadline = start + p->period;
+}
+
+void ResetFramePacer(FramePacer *p) {
+  const auto now = PacerClock::now();
+  p->last = now - p->period;
+  p->deadline = now;
+}
+} // namespace fb
@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <archive.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <result.hpp>
+#include <vector>
+
+/* Packs the given files into an asset archive. Used by the build as:
+ * pack <archive> <root directory> <paths relative to the root>...
+ * The entries are named after their paths relative to the root.
+ */
+int main(int argc, char **argv) {
+  namespace fs = std::filesystem;
+
+  if (argc < 3) {
+    std::cerr << "(ERR): Usage: pack <archive> <root> <files>..." << std::endl;
+    return fb::Result::SyntaxError;
+  }
+
+  const fs::path root{argv[2]};
+  std::vector<std::string> names;
+  for (int i = 3; i < argc; ++i) {
+    names.push_back(fb::GetArchiveEntryName(argv[i]));
+    if (names.back().size() >= fb::pak::nameLength) {
+      std::cerr << "(ERR): The entry name: '" << names.back()
+                << "' is too long!" << std::endl;
+      return fb::Result::DomainError;
+    }
+  }
+  std::sort(names.begin(), names.end());
+
+  fb::pak::Header h{};
+  std::memcpy(h.magic, fb::pak::magic, sizeof(h.magic));
+  h.version = fb::pak::version;
+  h.count = names.size();
+
+  auto align = [](std::uint64_t v) {
+    return (v + fb::pak::alignment - 1) / fb::pak::alignment *
+           fb::pak::alignment;
+  };
+
+  std::vector<fb::pak::Entry> entries(names.size());
+  std::uint64_t offset =
+      align(sizeof(h) + entries.size() * sizeof(fb::pak::Entry));
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    std::error_code ec;
+    const auto size = fs::file_size(root / names[i], ec);
+    if (ec) {
+      std::cerr << "(ERR): Failed to read: '" << (root / names[i]).string()
+                << "'" << std::endl;
+      return fb::Result::ReadError;
+    }
+
+    std::strncpy(entries[i].name, names[i].c_str(), fb::pak::nameLength);
+    entries[i].offset = offset;
+    entries[i].size = size;
+    offset = align(offset + size);
+  }
+
+  std::ofstream out{argv[1], std::ios::binary | std::ios::trunc};
+  out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+  out.write(reinterpret_cast<const char *>(entries.data()),
+            entries.size() * sizeof(fb::pak::Entry));
+
+  std::uint64_t end = sizeof(h) + entries.size() * sizeof(fb::pak::Entry);
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    /* Copying nothing out of a stream counts as a failure */
+    if (!entries[i].size)
+      continue;
+    std::ifstream in{root / names[i], std::ios::binary};
+    out.seekp(entries[i].offset);
+    out << in.rdbuf();
+    end = entries[i].offset + entries[i].size;
+  }
+
+  /* Pad the end, so that the size of the archive is aligned as well */
+  if (offset > end) {
+    out.seekp(offset - 1);
+    out.put('\0');
+  }
+
+  if (!out) {
+    std::cerr << "(ERR): Failed to write: '" << argv[1] << "'" << std::endl;
+    return fb::Result::Error;
+  }
+
+  return fb::Result::Success;
+}
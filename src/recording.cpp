@@ -0,0 +1,177 @@
+#include <cstring>
+#include <fstream>
+#include <recording.hpp>
+#include <result.hpp>
+
+namespace {
+/* FNV-1a, fed with the bytes of each value */
+struct Hasher {
+  std::uint32_t state{2166136261u};
+
+  void add(const void *data, std::size_t size) {
+    const auto *p = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; ++i)
+      state = (state ^ p[i]) * 16777619u;
+  }
+
+  template <typename T> void add(const T &v) { add(&v, sizeof(v)); }
+
+  template <typename T> void add(const std::vector<T> &v) {
+    add(v.data(), v.size() * sizeof(T));
+  }
+};
+} // namespace
+
+namespace fb::sim {
+std::uint32_t Hash(const World &w) {
+  Hasher h;
+  const auto &b = w.bird.body;
+  for (float v : {b.x, b.y, b.w, b.h, w.bird.v, w.rocketPhase})
+    h.add(v);
+
+  const auto &f = w.fences;
+  for (auto *v : {&f.x, &f.y, &f.w, &f.h, &f.v, &f.dir})
+    h.add(*v);
+  h.add(f.score);
+
+  const auto &r = w.rockets;
+  for (auto *v : {&r.x, &r.y, &r.w, &r.h})
+    h.add(*v);
+
+  for (auto *g : {&w.fenceRng, &w.rocketRng}) {
+    h.add(g->state);
+    h.add(g->inc);
+  }
+
+  h.add(w.score);
+  h.add(w.launched);
+  h.add(w.gameOver);
+  return h.state;
+}
+
+int Reset(World *w, Recording *r, const Config &c) {
+  if (!r)
+    return Result::DomainError;
+  if (auto res = Reset(w, c); res != Result::Success)
+    return res;
+
+  *r = {};
+  r->config = c;
+  return Result::Success;
+}
+
+int Step(World *w, Recording *r, Input in) {
+  if (!r)
+    return Result::DomainError;
+  if (auto res = Step(w, in); res != Result::Success)
+    return res;
+
+  r->inputs.push_back(in);
+  r->hashes.push_back(Hash(*w));
+  return Result::Success;
+}
+
+int WriteRecording(const Recording &r, const std::string &path) {
+  const auto &c = r.config;
+  rec::Header h{};
+  std::memcpy(h.magic, rec::magic, sizeof(h.magic));
+  h.version = rec::version;
+  h.width = c.width;
+  h.height = c.height;
+  h.birdWidth = c.birdWidth;
+  h.birdHeight = c.birdHeight;
+  h.rocketWidth = c.rocketWidth;
+  h.rocketHeight = c.rocketHeight;
+  h.fenceCount = c.fenceCount;
+  h.rocketCount = c.rocketCount;
+  h.seed = c.seed;
+  h.tick = c.tick;
+  h.count = r.inputs.size();
+
+  std::vector<char> body(h.count * rec::recordSize);
+  for (std::size_t i = 0; i < h.count; ++i) {
+    char *p = body.data() + i * rec::recordSize;
+    p[0] = r.inputs[i].flap ? rec::flap : 0;
+    std::memcpy(p + 1, &r.hashes[i], sizeof(std::uint32_t));
+  }
+
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+  out.write(body.data(), body.size());
+  return out ? Result::Success : Result::Error;
+}
+
+int ReadRecording(Recording *r, const std::string &path) {
+  if (!r)
+    return Result::DomainError;
+
+  std::ifstream in{path, std::ios::binary};
+  if (!in)
+    return Result::NotFound;
+
+  rec::Header h{};
+  if (!in.read(reinterpret_cast<char *>(&h), sizeof(h)))
+    return Result::ReadError;
+  if (std::memcmp(h.magic, rec::magic, sizeof(h.magic)) ||
+      h.version != rec::version)
+    return Result::SyntaxError;
+
+  /* The count is checked against what the file holds before anything is
+   * allocated for it, so that a corrupt header is reported, not thrown
+   */
+  const auto start = in.tellg();
+  in.seekg(0, std::ios::end);
+  const auto end = in.tellg();
+  in.seekg(start);
+  if (start < 0 || end < start || !in)
+    return Result::ReadError;
+  if (h.count > static_cast<std::uint64_t>(end - start) / rec::recordSize)
+    return Result::SyntaxError;
+
+  std::vector<char> body(h.count * rec::recordSize);
+  if (!in.read(body.data(), body.size()))
+    return Result::ReadError;
+
+  *r = {};
+  auto &c = r->config;
+  c.width = h.width;
+  c.height = h.height;
+  c.birdWidth = h.birdWidth;
+  c.birdHeight = h.birdHeight;
+  c.rocketWidth = h.rocketWidth;
+  c.rocketHeight = h.rocketHeight;
+  c.fenceCount = h.fenceCount;
+  c.rocketCount = h.rocketCount;
+  c.seed = h.seed;
+  c.tick = h.tick;
+
+  r->inputs.resize(h.count);
+  r->hashes.resize(h.count);
+  for (std::size_t i = 0; i < h.count; ++i) {
+    const char *p = body.data() + i * rec::recordSize;
+    r->inputs[i].flap = p[0] & rec::flap;
+    std::memcpy(&r->hashes[i], p + 1, sizeof(std::uint32_t));
+  }
+
+  return Result::Success;
+}
+
+int Replay(const Recording &r, World *w, std::size_t *mismatch) {
+  if (!w || r.inputs.size() != r.hashes.size())
+    return Result::DomainError;
+  if (auto res = Reset(w, r.config); res != Result::Success)
+    return res;
+
+  for (std::size_t i = 0; i < r.inputs.size(); ++i) {
+    if (auto res = Step(w, r.inputs[i]); res != Result::Success)
+      return res;
+    if (Hash(*w) != r.hashes[i]) {
+      if (mismatch)
+        *mismatch = i;
+      return Result::Error;
+    }
+  }
+
+  return Result::Success;
+}
+} // namespace fb::sim
@@ -0,0 +1,44 @@
+#include <chrono>
+#include <iostream>
+#include <recording.hpp>
+#include <result.hpp>
+
+/* Replays a recording without a window and as fast as possible, checking
+ * the state of the world after every step. Used as:
+ * replay <recording>
+ */
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    std::cerr << "(ERR): Usage: replay <recording>" << std::endl;
+    return fb::Result::SyntaxError;
+  }
+
+  fb::sim::Recording r;
+  if (auto res = fb::sim::ReadRecording(&r, argv[1]);
+      res != fb::Result::Success) {
+    std::cerr << "(ERR): Failed to read: '" << argv[1]
+              << "' with error code: " << res << std::endl;
+    return res;
+  }
+
+  fb::sim::World w;
+  std::size_t mismatch{0};
+  const auto start = std::chrono::steady_clock::now();
+  const auto res = fb::sim::Replay(r, &w, &mismatch);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  if (res == fb::Result::Error) {
+    std::cerr << "(ERR): The state diverged at step: " << mismatch
+              << std::endl;
+    return res;
+  } else if (res != fb::Result::Success) {
+    std::cerr << "(ERR): Failed to replay with error code: " << res
+              << std::endl;
+    return res;
+  }
+
+  std::cout << r.inputs.size() << " steps replayed in " << elapsed.count()
+            << " s, final score: " << w.score << std::endl;
+  return fb::Result::Success;
+}
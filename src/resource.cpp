@@ -1,7 +1,11 @@
 #include "result.hpp"
+#include <archive.hpp>
 #include <filesystem>
+#include <imagecache.hpp>
 #include <iostream>
 #include <resource.hpp>
+#include <system_error>
+#include <trace.hpp>
 
 namespace fs = std::filesystem;
 
@@ -34,11 +38,64 @@ int ValidateResourceParameters(std::unordered_map<std::string, T> *dst,
 
   return fb::Result::Success;
 }
+
+std::string GetCanonicalPath(const std::string &path) {
+  std::error_code ec;
+  auto p = fs::weakly_canonical(path, ec);
+  return ec ? path : p.string();
+}
+
+template <typename T>
+int ValidateArchiveParameters(std::unordered_map<std::string, T> *dst,
+                              const std::string &id, fb::Archive *ar,
+                              const std::string &name, const void **data,
+                              std::size_t *size) {
+  if (!dst || !id.size() || dst->contains(id)) {
+    std::cerr << "(ERR): The resource id: '" << id << "' is not valid!"
+              << std::endl;
+    return fb::Result::DomainError;
+  }
+
+  if (auto r = fb::FindArchiveEntry(ar, name, data, size);
+      r != fb::Result::Success) {
+    std::cerr << "(ERR): The archive entry: '" << name << "' is not valid!"
+              << std::endl;
+    return r;
+  }
+
+  return fb::Result::Success;
+}
+
+/* Looks the resource up by its key and reads it on a miss. The reader has
+ * the signature of ReadTexture and ReadFont, minus the path.
+ */
+template <typename T, typename Reader>
+int AcquireByKey(std::unordered_map<std::string, std::shared_ptr<T>> *cache,
+                 const std::string &key, std::shared_ptr<T> *dst,
+                 Reader read) {
+  if (!dst)
+    return fb::Result::DomainError;
+
+  if (auto it = cache->find(key); it != cache->end()) {
+    *dst = it->second;
+    return fb::Result::Success;
+  }
+
+  std::unordered_map<std::string, T> tmp;
+  if (auto r = read(&tmp, key); r != fb::Result::Success)
+    return r;
+
+  auto handle = std::make_shared<T>(std::move(tmp.at(key)));
+  cache->emplace(key, handle);
+  *dst = std::move(handle);
+  return fb::Result::Success;
+}
 } // namespace
 
 namespace fb {
 int ReadTexture(TextureMap *dst, const std::string &id,
                 const std::string &path) {
+  TraceSpan span{"read texture", path};
   if (auto r = ValidateResourceParameters(dst, id, path); r != Result::Success)
     return r;
 
@@ -53,6 +110,7 @@ int ReadTexture(TextureMap *dst, const std::string &id,
 }
 
 int ReadFont(FontMap *dst, const std::string &id, const std::string &path) {
+  TraceSpan span{"read font", path};
   if (auto r = ValidateResourceParameters(dst, id, path); r != Result::Success)
     return r;
 
@@ -65,4 +123,208 @@ int ReadFont(FontMap *dst, const std::string &id, const std::string &path) {
   dst->emplace(id, std::move(f));
   return Result::Success;
 }
+
+int ReadTexture(TextureMap *dst, const std::string &id, Archive *ar,
+                const std::string &name) {
+  TraceSpan span{"read texture", name};
+  const void *data{nullptr};
+  std::size_t size{0};
+  if (auto r = ValidateArchiveParameters(dst, id, ar, name, &data, &size);
+      r != Result::Success)
+    return r;
+
+  sf::Texture t;
+  if (!t.loadFromMemory(data, size)) {
+    std::cerr << "(ERR): Failed to load texture: '" << name << std::endl;
+    return Result::ReadError;
+  }
+
+  dst->emplace(id, std::move(t));
+  return Result::Success;
+}
+
+int ReadFont(FontMap *dst, const std::string &id, Archive *ar,
+             const std::string &name) {
+  TraceSpan span{"read font", name};
+  const void *data{nullptr};
+  std::size_t size{0};
+  if (auto r = ValidateArchiveParameters(dst, id, ar, name, &data, &size);
+      r != Result::Success)
+    return r;
+
+  sf::Font f;
+  if (!f.openFromMemory(data, size)) {
+    std::cerr << "(ERR): Failed to load font: '" << name << std::endl;
+    return Result::ReadError;
+  }
+
+  dst->emplace(id, std::move(f));
+  return Result::Success;
+}
+
+struct ResourceCache {
+  std::unordered_map<std::string, TextureHandle> textures;
+  std::unordered_map<std::string, FontHandle> fonts;
+  Archive *archive{nullptr};
+  ImageCache *images{nullptr};
+};
+
+namespace {
+/* Resources found in the mounted archive are keyed by their entry name,
+ * everything else by the canonical path of its file.
+ */
+bool IsInArchive(ResourceCache *c, const std::string &name) {
+  const void *data{nullptr};
+  std::size_t size{0};
+  return c->archive && FindArchiveEntry(c->archive, name, &data, &size) ==
+                           Result::Success;
+}
+
+/* Uploads the image of the key straight from the image cache. On a miss
+ * the image is decoded, and cached for the next time.
+ */
+template <typename Decode>
+int ReadThroughImageCache(ImageCache *images, TextureMap *dst,
+                          const std::string &id, const ImageKey &key,
+                          Decode decode) {
+  TraceSpan span{"read texture", key.source};
+  sf::Texture t;
+  if (ReadCachedTexture(images, key, &t) != Result::Success) {
+    sf::Image img;
+    if (!decode(img)) {
+      std::cerr << "(ERR): Failed to load texture: '" << key.source
+                << std::endl;
+      return Result::ReadError;
+    }
+    WriteCachedImage(images, key, img);
+    if (!t.loadFromImage(img)) {
+      std::cerr << "(ERR): Failed to load texture: '" << key.source
+                << std::endl;
+      return Result::ReadError;
+    }
+  }
+
+  dst->emplace(id, std::move(t));
+  return Result::Success;
+}
+
+template <typename T, typename FileReader, typename ArchiveReader>
+int Acquire(ResourceCache *c,
+            std::unordered_map<std::string, std::shared_ptr<T>> *cache,
+            const std::string &path, std::shared_ptr<T> *dst,
+            FileReader readFile, ArchiveReader readArchive) {
+  if (auto name = GetArchiveEntryName(path); IsInArchive(c, name))
+    return AcquireByKey(cache, name, dst, [&](auto *m, const std::string &id) {
+      return readArchive(m, id, c->archive, name);
+    });
+
+  return AcquireByKey(cache, GetCanonicalPath(path), dst,
+                      [&](auto *m, const std::string &id) {
+                        return readFile(m, id, path);
+                      });
+}
+} // namespace
+
+int CreateResourceCache(ResourceCache *&c) {
+  c = new ResourceCache{};
+  return Result::Success;
+}
+
+int DestroyResourceCache(ResourceCache *c) {
+  delete c;
+  return Result::Success;
+}
+
+int MountArchive(ResourceCache *c, Archive *ar) {
+  if (!c)
+    return Result::DomainError;
+  c->archive = ar;
+  return Result::Success;
+}
+
+Archive *GetMountedArchive(ResourceCache *c) {
+  return c ? c->archive : nullptr;
+}
+
+int MountImageCache(ResourceCache *c, ImageCache *images) {
+  if (!c)
+    return Result::DomainError;
+  c->images = images;
+  return Result::Success;
+}
+
+ImageCache *GetMountedImageCache(ResourceCache *c) {
+  return c ? c->images : nullptr;
+}
+
+int AcquireTexture(ResourceCache *c, const std::string &path,
+                   TextureHandle *dst) {
+  if (!c)
+    return Result::DomainError;
+
+  using File = int (*)(TextureMap *, const std::string &, const std::string &);
+  using Pak = int (*)(TextureMap *, const std::string &, Archive *,
+                      const std::string &);
+  if (!c->images)
+    return Acquire(c, &c->textures, path, dst, static_cast<File>(ReadTexture),
+                   static_cast<Pak>(ReadTexture));
+
+  /* Without a key there is nothing to validate an entry against */
+  auto file = [c](TextureMap *m, const std::string &id,
+                  const std::string &p) {
+    if (auto r = ValidateResourceParameters(m, id, p); r != Result::Success)
+      return r;
+    ImageKey k;
+    if (GetImageKey(p, &k) != Result::Success)
+      return ReadTexture(m, id, p);
+    return ReadThroughImageCache(c->images, m, id, k, [&p](sf::Image &img) {
+      return img.loadFromFile(p);
+    });
+  };
+  auto pak = [c](TextureMap *m, const std::string &id, Archive *ar,
+                 const std::string &name) {
+    const void *data{nullptr};
+    std::size_t size{0};
+    if (auto r = ValidateArchiveParameters(m, id, ar, name, &data, &size);
+        r != Result::Success)
+      return r;
+    ImageKey k;
+    if (GetImageKey(ar, name, &k) != Result::Success)
+      return ReadTexture(m, id, ar, name);
+    return ReadThroughImageCache(c->images, m, id, k,
+                                 [data, size](sf::Image &img) {
+                                   return img.loadFromMemory(data, size);
+                                 });
+  };
+  return Acquire(c, &c->textures, path, dst, file, pak);
+}
+
+int AcquireFont(ResourceCache *c, const std::string &path, FontHandle *dst) {
+  if (!c)
+    return Result::DomainError;
+
+  using File = int (*)(FontMap *, const std::string &, const std::string &);
+  using Pak =
+      int (*)(FontMap *, const std::string &, Archive *, const std::string &);
+  return Acquire(c, &c->fonts, path, dst, static_cast<File>(ReadFont),
+                 static_cast<Pak>(ReadFont));
+}
+
+int StoreTexture(ResourceCache *c, const std::string &path,
+                 const sf::Image &img, TextureHandle *dst) {
+  if (!c)
+    return Result::DomainError;
+
+  auto read = [&img](TextureMap *m, const std::string &id, auto &&...) {
+    sf::Texture t;
+    if (!t.loadFromImage(img)) {
+      std::cerr << "(ERR): Failed to load texture: '" << id << std::endl;
+      return Result::ReadError;
+    }
+    m->emplace(id, std::move(t));
+    return Result::Success;
+  };
+
+  return Acquire(c, &c->textures, path, dst, read, read);
+}
 } // namespace fb
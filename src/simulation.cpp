@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <cmath>
+#include <result.hpp>
+#include <simulation.hpp>
+
+namespace {
+/* The game was originally tuned in pixels per frame at 60 frames per
+ * second. The constants below keep that feel at any tick rate.
+ */
+constexpr float referenceRate{60.f};
+constexpr float gravity{9.81f * referenceRate};
+constexpr float flapAcceleration{0.5f * referenceRate * referenceRate};
+constexpr float fenceWidth{50.f};
+constexpr float fenceSpeed{2.f * referenceRate};
+constexpr float fenceLift{2.f * referenceRate};
+constexpr float fenceAcceleration{0.1f * referenceRate};
+constexpr float rocketSpeed{5.f * referenceRate};
+constexpr float rocketPhaseSpeed{6.28f / 1800.f * referenceRate};
+constexpr float rocketPhaseEnd{6.28f};
+constexpr unsigned fenceMotionScore{5};
+constexpr unsigned rocketScore{10};
+
+unsigned GetRandomNumber(fb::Pcg32 *g, unsigned inclBegin, unsigned exclEnd) {
+  return fb::NextInRange(g, inclBegin, exclEnd);
+}
+
+/* Updates the fences in [0, end). A fence is moved when it was on screen
+ * at the start of the step, and respawned past the right edge otherwise.
+ * The moving loops only select between values, using float masks rather
+ * than branches, so that the compiler can vectorize them.
+ */
+void UpdateFences(fb::sim::World *w, std::size_t end, float maxSpeed) {
+  auto &f = w->fences;
+  const auto &c = w->config;
+  const float dt = c.tick;
+
+  float *x = f.x.data(), *y = f.y.data(), *v = f.v.data();
+  float *dir = f.dir.data();
+  const float *lx = f.lastX.data(), *fw = f.w.data(), *fh = f.h.data();
+
+  for (std::size_t i = 0; i < end; ++i) {
+    const float moving = lx[i] > -fw[i] ? 1.f : 0.f;
+    x[i] -= moving * v[i] * dt;
+  }
+
+  if (w->score >= fenceMotionScore)
+    for (std::size_t i = 0; i < end; ++i) {
+      const float moving = lx[i] > -fw[i] ? 1.f : 0.f;
+      const float ny = y[i] + moving * dir[i] * fenceLift * dt;
+      const float top = ny <= 0 ? moving : 0.f;
+      const float bottom = ny >= c.height - fh[i] ? moving : 0.f;
+      float d = dir[i];
+      d = top > 0 ? 1.f : d;
+      d = bottom > 0 ? -1.f : d;
+      y[i] = ny;
+      dir[i] = d;
+    }
+
+  const float dv = dt * fenceAcceleration;
+  for (std::size_t i = 0; i < end; ++i)
+    v[i] += v[i] < maxSpeed ? dv : 0.f;
+
+  /* Respawning draws random numbers, so it is done in order */
+  for (std::size_t i = 0; i < end; ++i)
+    if (!(lx[i] > -fw[i])) {
+      f.w[i] = fenceWidth;
+      f.h[i] = (200.f / 540.f) * c.height;
+      f.x[i] = f.lastX[i] = c.width;
+      f.y[i] = f.lastY[i] = GetRandomNumber(&w->fenceRng, 0, c.height - f.h[i]);
+      f.score[i] = true;
+    }
+}
+
+/* Scores each fence in [0, end) once the bird has flown past it */
+unsigned ScoreFences(fb::sim::World *w, std::size_t end) {
+  const auto &b = w->bird.body;
+  const float birdRight = b.x + b.w;
+  const float offset = 3.f / 2.f * b.w;
+  const float *x = w->fences.x.data();
+  std::uint8_t *score = w->fences.score.data();
+
+  unsigned points = 0;
+  for (std::size_t i = 0; i < end; ++i) {
+    const bool passed = birdRight > x[i] + offset && score[i];
+    points += passed;
+    score[i] = passed ? 0 : score[i];
+  }
+  return points;
+}
+
+/* Every rocket advances the shared phase, so they are updated in order */
+void UpdateRockets(fb::sim::World *w, std::size_t end) {
+  auto &r = w->rockets;
+  const auto &c = w->config;
+
+  for (std::size_t i = 0; i < end; ++i)
+    if (r.x[i] < -r.w[i]) {
+      r.x[i] = r.lastX[i] =
+          c.width * 2 + GetRandomNumber(&w->rocketRng, 0, c.width);
+      r.y[i] = r.lastY[i] = c.height / 2.f;
+    } else {
+      r.x[i] -= rocketSpeed * c.tick;
+      r.y[i] = c.height / 2.f + std::sin(w->rocketPhase) * c.height * 0.4f;
+      w->rocketPhase += rocketPhaseSpeed * c.tick;
+      if (w->rocketPhase > rocketPhaseEnd)
+        w->rocketPhase = 0;
+    }
+}
+} // namespace
+
+namespace fb::sim {
+Rect Interpolate(const Rect &last, const Rect &now, float alpha) {
+  return {last.x + (now.x - last.x) * alpha, last.y + (now.y - last.y) * alpha,
+          now.w, now.h};
+}
+
+std::size_t Count(const Fences &f) { return f.x.size(); }
+
+std::size_t Count(const Rockets &r) { return r.x.size(); }
+
+Rect GetBody(const Fences &f, std::size_t i) {
+  return {f.x[i], f.y[i], f.w[i], f.h[i]};
+}
+
+Rect GetLastBody(const Fences &f, std::size_t i) {
+  return {f.lastX[i], f.lastY[i], f.w[i], f.h[i]};
+}
+
+Rect GetBody(const Rockets &r, std::size_t i) {
+  return {r.x[i], r.y[i], r.w[i], r.h[i]};
+}
+
+Rect GetLastBody(const Rockets &r, std::size_t i) {
+  return {r.lastX[i], r.lastY[i], r.w[i], r.h[i]};
+}
+
+int Reset(World *w, const Config &c) {
+  if (!w || c.tick <= 0)
+    return Result::DomainError;
+
+  *w = World{};
+  w->config = c;
+  Seed(&w->fenceRng, c.seed, stream::fences);
+  Seed(&w->rocketRng, c.seed, stream::rockets);
+
+  w->bird.body = {(c.width - c.birdWidth) / 2.f, c.height / 2.f - c.birdHeight,
+                  c.birdWidth, c.birdHeight};
+  w->bird.last = w->bird.body;
+
+  auto &f = w->fences;
+  for (unsigned i = 0; i < c.fenceCount; ++i) {
+    const float h = c.height - GetRandomNumber(&w->fenceRng, 160 * 1.5f,
+                                               2.f / 3.f * c.height);
+    const float y = GetRandomNumber(&w->fenceRng, 0, 2) ? 0 : c.height - h;
+    f.x.push_back(c.width + i * (c.width / 2.f));
+    f.y.push_back(y);
+    f.w.push_back(fenceWidth);
+    f.h.push_back(h);
+    f.v.push_back(fenceSpeed);
+    f.dir.push_back(i % 2 ? -1.f : 1.f);
+    f.score.push_back(true);
+  }
+  f.lastX = f.x;
+  f.lastY = f.y;
+
+  auto &r = w->rockets;
+  for (unsigned i = 0; i < c.rocketCount; ++i) {
+    r.x.push_back(c.width * (i + 1));
+    r.y.push_back(250.f + 150.f * i);
+    r.w.push_back(c.rocketWidth);
+    r.h.push_back(c.rocketHeight);
+  }
+  r.lastX = r.x;
+  r.lastY = r.y;
+
+  return Result::Success;
+}
+
+int Step(World *w, Input in) {
+  if (!w)
+    return Result::DomainError;
+
+  auto &bird = w->bird;
+  bird.last = bird.body;
+  auto &fences = w->fences;
+  auto &rockets = w->rockets;
+  fences.lastX = fences.x;
+  fences.lastY = fences.y;
+  rockets.lastX = rockets.x;
+  rockets.lastY = rockets.y;
+
+  if (in.flap)
+    w->launched = true;
+
+  if (!w->launched || w->gameOver)
+    return Result::Success;
+
+  const float dt = w->config.tick;
+  bird.v += gravity * dt;
+  bird.body.y += bird.v * dt;
+
+  if (in.flap)
+    bird.v -= flapAcceleration * dt;
+
+  /* Every obstacle is tested before it moves, so all of them can be
+   * tested up front. The game ends at the first one hit, in the order
+   * in which they are updated, and the ones after it stay in place.
+   */
+  const std::size_t fenceCount = Count(fences);
+  const std::size_t rocketCount = Count(rockets);
+  w->colliderRects.clear();
+  for (std::size_t i = 0; i < fenceCount; ++i)
+    w->colliderRects.push_back(GetBody(fences, i));
+  for (std::size_t i = 0; i < rocketCount; ++i)
+    w->colliderRects.push_back(GetBody(rockets, i));
+  if (auto r = Build(&w->colliders, w->colliderRects.data(),
+                     w->colliderRects.size());
+      r != Result::Success)
+    return r;
+  if (auto r = Query(&w->colliders, bird.body, &w->hits); r != Result::Success)
+    return r;
+
+  std::size_t fenceEnd = fenceCount, rocketEnd = rocketCount;
+  for (std::size_t i : w->hits)
+    if (i < fenceCount)
+      fenceEnd = std::min(fenceEnd, i);
+    else
+      rocketEnd = std::min(rocketEnd, i - fenceCount);
+
+  UpdateFences(w, fenceEnd, bird.body.w * referenceRate);
+  if (fenceEnd < fenceCount)
+    w->gameOver = true;
+
+  w->score += ScoreFences(w, fenceEnd);
+
+  if (w->score > rocketScore) {
+    UpdateRockets(w, rocketEnd);
+    if (rocketEnd < rocketCount)
+      w->gameOver = true;
+  }
+
+  if (bird.body.y < 0 || bird.body.y > w->config.height - bird.body.h)
+    w->gameOver = true;
+
+  return Result::Success;
+}
+} // namespace fb::sim
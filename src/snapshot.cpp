@@ -0,0 +1,158 @@
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <iostream>
+#include <result.hpp>
+#include <snapshot.hpp>
+#include <thread>
+#include <trace.hpp>
+#include <type_traits>
+
+namespace fb {
+/* Each slot is held by exactly one side at a time: the back one by the
+ * simulation thread, the front one by the render thread, and the middle
+ * one by neither. Publishing swaps the back slot with the middle one and
+ * marks it fresh, and the render thread swaps its front slot with the
+ * middle one only while it is fresh.
+ */
+struct RenderThread {
+  sf::RenderWindow *window;
+  std::array<Snapshot, 3> slots;
+
+  std::atomic<unsigned> middle{1};
+  unsigned back{0};
+  unsigned front{2};
+
+  /* The number of snapshots published, and how many of them were taken
+   * care of by the render thread
+   */
+  std::atomic<std::uint64_t> published{0}, drawn{0};
+  std::atomic<bool> stop{false};
+
+  /* In microseconds, negative while there is nothing to report */
+  std::atomic<std::int64_t> latency{-1};
+
+  std::thread thread;
+};
+
+namespace {
+constexpr unsigned fresh{4};
+constexpr unsigned index{3};
+
+void DrawLoop(RenderThread *r) {
+  SetTraceThreadName("render");
+
+  /* Without the context the snapshots are still taken, so that nobody
+   * waits for them forever
+   */
+  const bool active = r->window->setActive(true);
+  if (!active)
+    std::cerr << "(ERR): Failed to activate the window on the render thread"
+              << std::endl;
+
+  std::uint64_t seen{0};
+  while (true) {
+    r->published.wait(seen, std::memory_order_acquire);
+    seen = r->published.load(std::memory_order_acquire);
+    if (r->stop.load(std::memory_order_acquire))
+      break;
+
+    if (active && (r->middle.load(std::memory_order_relaxed) & fresh)) {
+      r->front = r->middle.exchange(r->front, std::memory_order_acq_rel) &
+                 index;
+
+      TraceSpan span{"draw"};
+      const Snapshot &s = r->slots[r->front];
+      r->window->clear();
+      Draw(*r->window, s);
+      r->window->display();
+
+      if (s.press)
+        r->latency.store(std::chrono::duration_cast<std::chrono::microseconds>(
+                             InputClock::now() - *s.press)
+                             .count(),
+                         std::memory_order_relaxed);
+    }
+
+    r->drawn.store(seen, std::memory_order_release);
+    r->drawn.notify_all();
+  }
+
+  if (active)
+    (void)r->window->setActive(false);
+}
+} // namespace
+
+void Draw(sf::RenderTarget &t, const Snapshot &s) {
+  for (auto &&item : s.items)
+    std::visit(
+        [&](const auto &d) {
+          if constexpr (std::same_as<std::decay_t<decltype(d)>, Vertices>)
+            t.draw(s.vertices.data() + d.first, d.count, d.type, item.states);
+          else
+            t.draw(d, item.states);
+        },
+        item.drawable);
+}
+
+int CreateRenderThread(RenderThread *&r, sf::RenderWindow *w) {
+  if (!w)
+    return Result::DomainError;
+
+  /* A context can only be active on one thread at a time */
+  if (!w->setActive(false))
+    return Result::Error;
+
+  r = new RenderThread{};
+  r->window = w;
+  r->thread = std::thread{DrawLoop, r};
+  return Result::Success;
+}
+
+int DestroyRenderThread(RenderThread *r) {
+  if (!r)
+    return Result::DomainError;
+
+  r->stop.store(true, std::memory_order_release);
+  r->published.fetch_add(1, std::memory_order_release);
+  r->published.notify_one();
+  r->thread.join();
+  delete r;
+  return Result::Success;
+}
+
+Snapshot *GetBackSnapshot(RenderThread *r) {
+  auto &s = r->slots[r->back];
+  s.items.clear();
+  s.vertices.clear();
+  s.press.reset();
+  return &s;
+}
+
+void PublishSnapshot(RenderThread *r) {
+  r->back =
+      r->middle.exchange(r->back | fresh, std::memory_order_acq_rel) & index;
+  r->published.fetch_add(1, std::memory_order_release);
+  r->published.notify_one();
+}
+
+void WaitForRenderThread(RenderThread *r) {
+  const auto p = r->published.load(std::memory_order_acquire);
+  for (auto d = r->drawn.load(std::memory_order_acquire); d < p;
+       d = r->drawn.load(std::memory_order_acquire))
+    r->drawn.wait(d, std::memory_order_acquire);
+}
+
+int TakeDisplayLatency(RenderThread *r, std::chrono::microseconds *dst) {
+  if (!r || !dst)
+    return Result::DomainError;
+
+  const auto l = r->latency.exchange(-1, std::memory_order_relaxed);
+  if (l < 0)
+    return Result::NotFound;
+
+  *dst = std::chrono::microseconds{l};
+  return Result::Success;
+}
+} // namespace fb
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <result.hpp>
+#include <stats.hpp>
+#include <vector>
+
+namespace {
+/* Samples below 64us get a bucket each, above that every power of two is
+ * split into 32 linear buckets, which keeps the error of a percentile
+ * under about 3%. Samples are clamped to 2^32us, which is over an hour.
+ */
+constexpr unsigned subBits{5};
+constexpr unsigned subCount{1u << subBits};
+constexpr std::uint64_t maxSample{(1ull << 32) - 1};
+constexpr std::size_t bucketCount{(32 - subBits) * subCount + 2 * subCount};
+
+std::size_t GetBucket(std::uint64_t v) {
+  if (v < 2 * subCount)
+    return v;
+  const unsigned shift = std::bit_width(v) - 1 - subBits;
+  return shift * subCount + (v >> shift);
+}
+
+std::uint64_t GetBucketUpperBound(std::size_t b) {
+  if (b < 2 * subCount)
+    return b;
+  const unsigned shift = b / subCount - 1;
+  const std::uint64_t mantissa = b - shift * subCount;
+  return ((mantissa + 1) << shift) - 1;
+}
+
+struct Histogram {
+  std::vector<std::uint32_t> ring;
+  std::array<std::uint32_t, bucketCount> buckets{};
+  std::size_t head{0}, size{0};
+};
+
+struct Summary {
+  std::size_t samples{0};
+  std::uint64_t p50{0}, p95{0}, p99{0}, max{0};
+};
+
+void Record(Histogram *h, std::uint64_t sample) {
+  const auto v = static_cast<std::uint32_t>(std::min(sample, maxSample));
+
+  if (h->size == h->ring.size())
+    --h->buckets[GetBucket(h->ring[h->head])];
+  else
+    ++h->size;
+
+  h->ring[h->head] = v;
+  ++h->buckets[GetBucket(v)];
+  h->head = (h->head + 1) % h->ring.size();
+}
+
+Summary Summarize(const Histogram &h) {
+  Summary s{};
+  s.samples = h.size;
+  if (!h.size)
+    return s;
+
+  for (std::size_t i = 0; i < h.size; ++i)
+    s.max = std::max<std::uint64_t>(s.max, h.ring[i]);
+
+  const std::array<double, 3> quantiles{0.5, 0.95, 0.99};
+  std::array<std::uint64_t *, 3> out{&s.p50, &s.p95, &s.p99};
+  std::size_t q = 0, seen = 0;
+  for (std::size_t b = 0; b < bucketCount && q < quantiles.size(); ++b) {
+    seen += h.buckets[b];
+    while (q < quantiles.size() && seen >= quantiles[q] * h.size)
+      *out[q++] = std::min(GetBucketUpperBound(b), s.max);
+  }
+
+  return s;
+}
+} // namespace
+
+namespace fb {
+struct FrameStats {
+  std::array<Histogram, static_cast<std::size_t>(Phase::Count)> phases;
+  std::array<Histogram, static_cast<std::size_t>(Counter::Count)> counters;
+};
+
+int CreateFrameStats(FrameStats *&s, std::size_t window) {
+  if (!window)
+    return Result::DomainError;
+
+  s = new FrameStats{};
+  for (auto &&h : s->phases)
+    h.ring.resize(window);
+  for (auto &&h : s->counters)
+    h.ring.resize(window);
+  return Result::Success;
+}
+
+int DestroyFrameStats(FrameStats *s) {
+  delete s;
+  return Result::Success;
+}
+
+void RecordPhase(FrameStats *s, Phase p, std::chrono::microseconds d) {
+  if (!s || p == Phase::Count)
+    return;
+  Record(&s->phases[static_cast<std::size_t>(p)],
+         std::max<std::int64_t>(d.count(), 0));
+}
+
+int GetPhaseSummary(FrameStats *s, Phase p, PhaseSummary *dst) {
+  if (!s || !dst || p == Phase::Count)
+    return Result::DomainError;
+
+  const auto sum = Summarize(s->phases[static_cast<std::size_t>(p)]);
+  using us = std::chrono::microseconds;
+  *dst = {sum.samples, us(sum.p50), us(sum.p95), us(sum.p99), us(sum.max)};
+  return Result::Success;
+}
+
+void RecordCounter(FrameStats *s, Counter c, std::uint64_t v) {
+  if (!s || c == Counter::Count)
+    return;
+  Record(&s->counters[static_cast<std::size_t>(c)], v);
+}
+
+int GetCounterSummary(FrameStats *s, Counter c, CounterSummary *dst) {
+  if (!s || !dst || c == Counter::Count)
+    return Result::DomainError;
+
+  const auto sum = Summarize(s->counters[static_cast<std::size_t>(c)]);
+  *dst = {sum.samples, sum.p50, sum.p95, sum.p99, sum.max};
+  return Result::Success;
+}
+
+const char *GetCounterName(Counter c) {
+  switch (c) {
+  case Counter::DrawCalls:
+    return "draws";
+  case Counter::Vertices:
+    return "vertices";
+  default:
+    return "unknown";
+  }
+}
+
+const char *GetPhaseName(Phase p) {
+  switch (p) {
+  case Phase::Frame:
+    return "frame";
+  case Phase::Events:
+    return "events";
+  case Phase::Assets:
+    return "assets";
+  case Phase::Update:
+    return "update";
+  case Phase::Render:
+    return "render";
+  case Phase::Display:
+    return "display";
+  case Phase::Commands:
+    return "commands";
+  case Phase::Latency:
+    return "latency";
+  case Phase::Jitter:
+    return "jitter";
+  default:
+    return "unknown";
+  }
+}
+
+int WriteFrameStats(FrameStats *s, const std::string &path) {
+  if (!s)
+    return Result::DomainError;
+
+  std::ofstream out{path};
+  if (!out) {
+    std::cerr << "(ERR): Failed to open: '" << path << "'" << std::endl;
+    return Result::ReadError;
+  }
+
+  out << "name,samples,p50,p95,p99,max\n";
+  for (int i = 0; i < static_cast<int>(Phase::Count); ++i) {
+    PhaseSummary ps{};
+    GetPhaseSummary(s, static_cast<Phase>(i), &ps);
+    out << GetPhaseName(static_cast<Phase>(i)) << ',' << ps.samples << ','
+        << ps.p50.count() << ',' << ps.p95.count() << ',' << ps.p99.count()
+        << ',' << ps.max.count() << '\n';
+  }
+
+  for (int i = 0; i < static_cast<int>(Counter::Count); ++i) {
+    CounterSummary cs{};
+    GetCounterSummary(s, static_cast<Counter>(i), &cs);
+    out << GetCounterName(static_cast<Counter>(i)) << ',' << cs.samples << ','
+        << cs.p50 << ',' << cs.p95 << ',' << cs.p99 << ',' << cs.max << '\n';
+  }
+
+  return out ? Result::Success : Result::Error;
+}
+} // namespace fb
@@ -0,0 +1,222 @@
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <result.hpp>
+#include <string>
+#include <trace.hpp>
+#include <vector>
+
+namespace fb {
+namespace {
+/* Times are in nanoseconds since the tracer was created. For spans the
+ * value is the duration, for counters the count.
+ */
+struct TraceEvent {
+  const char *name;
+  std::int64_t at, value;
+  std::uint32_t detail, detailSize;
+  char phase;
+};
+
+/* Only the owning thread records into a buffer, so its lock is contended
+ * only while the trace is written
+ */
+struct TraceBuffer {
+  std::mutex mutex;
+  std::vector<TraceEvent> events;
+  std::string details;
+  std::string name;
+  std::size_t id{0};
+  std::uint64_t dropped{0};
+};
+
+/* The buffers outlive their threads, so that a trace written at exit
+ * still shows the threads which are gone by then
+ */
+struct Tracer {
+  TraceClock::time_point epoch{TraceClock::now()};
+  std::mutex mutex;
+  std::vector<std::unique_ptr<TraceBuffer>> buffers;
+};
+
+/* Beyond that, the events of a thread are counted as dropped */
+constexpr std::size_t maxEvents{1 << 20};
+
+Tracer &GetTracer() {
+  static Tracer t;
+  return t;
+}
+
+/* A thread gets a buffer with its first event only, so that naming a
+ * thread costs nothing while tracing is off
+ */
+thread_local TraceBuffer *threadBuffer{nullptr};
+thread_local std::string threadName;
+
+TraceBuffer *GetThreadBuffer() {
+  if (!threadBuffer) {
+    auto &t = GetTracer();
+    std::lock_guard lock{t.mutex};
+    auto &p = t.buffers.emplace_back(std::make_unique<TraceBuffer>());
+    p->id = t.buffers.size();
+    p->name = threadName;
+    p->events.reserve(4096);
+    threadBuffer = p.get();
+  }
+  return threadBuffer;
+}
+
+std::int64_t SinceEpoch(TraceClock::time_point t) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             t - GetTracer().epoch)
+      .count();
+}
+
+void Record(const char *name, char phase, std::int64_t at,
+            std::int64_t value, std::string_view detail) {
+  auto b = GetThreadBuffer();
+  std::lock_guard lock{b->mutex};
+  if (b->events.size() == maxEvents) {
+    ++b->dropped;
+    return;
+  }
+  b->events.push_back({name, at, value,
+                       static_cast<std::uint32_t>(b->details.size()),
+                       static_cast<std::uint32_t>(detail.size()), phase});
+  b->details.append(detail);
+}
+
+void WriteString(std::ostream &out, std::string_view s) {
+  out << '"';
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char esc[8];
+      std::snprintf(esc, sizeof esc, "\\u%04x",
+                    static_cast<unsigned>(c));
+      out << esc;
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+}
+
+/* The viewers expect microseconds */
+void WriteTime(std::ostream &out, const char *key, std::int64_t ns) {
+  out << ",\"" << key << "\":" << ns / 1000 << '.' << std::setw(3)
+      << std::setfill('0') << ns % 1000;
+}
+
+void WriteEvent(std::ostream &out, const TraceEvent &e,
+                const std::string &details, std::size_t tid) {
+  out << "{\"name\":";
+  WriteString(out, e.name);
+  out << ",\"ph\":\"" << e.phase << "\",\"pid\":1,\"tid\":" << tid;
+  WriteTime(out, "ts", e.at);
+  if (e.phase == 'X')
+    WriteTime(out, "dur", e.value);
+  else if (e.phase == 'i')
+    out << ",\"s\":\"t\"";
+
+  if (e.phase == 'C') {
+    out << ",\"args\":{\"value\":" << e.value << '}';
+  } else if (e.detailSize) {
+    out << ",\"args\":{\"detail\":";
+    WriteString(out,
+                std::string_view{details}.substr(e.detail, e.detailSize));
+    out << '}';
+  }
+  out << '}';
+}
+} // namespace
+
+void EnableTracing(bool v) {
+  /* Creates the epoch before the first event is recorded */
+  (void)GetTracer();
+  tracing.store(v, std::memory_order_relaxed);
+}
+
+void SetTraceThreadName(const char *name) {
+  threadName = name ? name : "";
+  if (auto b = threadBuffer) {
+    std::lock_guard lock{b->mutex};
+    b->name = threadName;
+  }
+}
+
+void RecordTraceSpan(const char *name, std::string_view detail,
+                     TraceClock::time_point begin,
+                     TraceClock::time_point end) {
+  Record(name, 'X', SinceEpoch(begin),
+         std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
+             .count(),
+         detail);
+}
+
+void RecordTraceInstant(const char *name, std::string_view detail) {
+  Record(name, 'i', SinceEpoch(TraceClock::now()), 0, detail);
+}
+
+void RecordTraceCounter(const char *name, std::int64_t value) {
+  Record(name, 'C', SinceEpoch(TraceClock::now()), value, {});
+}
+
+int WriteTrace(const std::string &path) {
+  std::ofstream out{path};
+  if (!out) {
+    std::cerr << "(ERR): Failed to open: '" << path << "'" << std::endl;
+    return Result::Error;
+  }
+
+  auto &t = GetTracer();
+  std::lock_guard lock{t.mutex};
+
+  /* Each buffer is copied out first, so that its thread is held up by the
+   * copy only, not by the formatting
+   */
+  std::vector<TraceEvent> events;
+  std::string details, name;
+  std::uint64_t dropped{0};
+  bool first{true};
+
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  for (auto &&b : t.buffers) {
+    {
+      std::lock_guard l{b->mutex};
+      events = b->events;
+      details = b->details;
+      name = b->name;
+      dropped += b->dropped;
+    }
+
+    if (!name.empty()) {
+      out << (first ? "\n" : ",\n")
+          << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+          << b->id << ",\"args\":{\"name\":";
+      WriteString(out, name);
+      out << "}}";
+      first = false;
+    }
+    for (auto &&e : events) {
+      out << (first ? "\n" : ",\n");
+      WriteEvent(out, e, details, b->id);
+      first = false;
+    }
+  }
+  out << "\n]}\n";
+
+  if (dropped)
+    std::cerr << "(ERR): The trace is missing " << dropped
+              << " events, which did not fit into the buffers" << std::endl;
+  if (!out) {
+    std::cerr << "(ERR): Failed to write: '" << path << "'" << std::endl;
+    return Result::Error;
+  }
+  return Result::Success;
+}
+} // namespace fb
@@ -0,0 +1,65 @@
+#include <chrono>
+#include <environment.hpp>
+#include <iostream>
+#include <result.hpp>
+#include <string>
+#include <thread>
+
+/* Plays many games at once with a simple scripted bot, and reports how
+ * fast they are stepped and how well the bot does. Used as:
+ * tune <environments> <steps> [threads]
+ */
+int main(int argc, char **argv) {
+  if (argc != 3 && argc != 4) {
+    std::cerr << "(ERR): Usage: tune <environments> <steps> [threads]"
+              << std::endl;
+    return fb::Result::SyntaxError;
+  }
+
+  std::size_t count, steps;
+  unsigned threads = std::thread::hardware_concurrency();
+  try {
+    count = std::stoul(argv[1]);
+    steps = std::stoul(argv[2]);
+    if (argc == 4)
+      threads = std::stoul(argv[3]);
+  } catch (...) {
+    std::cerr << "(ERR): The arguments have to be numbers" << std::endl;
+    return fb::Result::ConversionError;
+  }
+
+  fb::sim::Environments *envs{nullptr};
+  if (auto r = fb::sim::CreateEnvironments(envs, {}, count,
+                                           threads ? threads : 1);
+      r != fb::Result::Success) {
+    std::cerr << "(ERR): Failed to create the environments with error code: "
+              << r << std::endl;
+    return r;
+  }
+
+  /* Launches, then keeps the bird level with the gap next to the fence */
+  const fb::sim::Policy bot = [](std::size_t, const float *o) {
+    const float target = o[3] > 0.f ? o[3] - 0.25f : o[3] + o[4] + 0.05f;
+    return fb::sim::Input{o[7] == 0.f || (o[0] > target && o[1] >= 0.f)};
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto r = fb::sim::Run(envs, bot, steps);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  if (r == fb::Result::Success) {
+    const auto episodes = fb::sim::GetEpisodeCount(envs);
+    std::cout << count * steps / elapsed.count() << " steps/s, " << episodes
+              << " games, mean score: "
+              << (episodes ? double(fb::sim::GetTotalScore(envs)) / episodes
+                           : 0.0)
+              << std::endl;
+  } else {
+    std::cerr << "(ERR): Failed to run the environments with error code: "
+              << r << std::endl;
+  }
+
+  fb::sim::DestroyEnvironments(envs);
+  return r;
+}